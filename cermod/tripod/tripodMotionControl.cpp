@@ -796,6 +796,20 @@ bool tripodMotionControl::fromConfig(yarp::os::Searchable &config)
     cer::kinematics::TripodParameters tParam(radius, lMin, lMax, alpha, _baseTransformation);
     solver.setParameters(tParam);
 
+    // optional lookup table for the inverse kinematics
+    if(tripod_description.check("LUT") && tripod_description.find("LUT").asBool())
+    {
+        double stepHeave = tripod_description.check("LUT_step_heave", Value(0.005)).asDouble();
+        double stepAngle = tripod_description.check("LUT_step_angle", Value(1.0)).asDouble();
+        std::string cache = tripod_description.check("LUT_cache", Value("")).asString();
+        if(!solver.enableLUT(stepHeave, stepAngle, cache))
+        {
+            yError() << "Unable to set up the tripod LUT";
+            return false;
+        }
+        yInfo() << "Tripod inverse kinematics relies on the LUT";
+    }
+
 
     Bottle &limits_group=config.findGroup("LIMITS");
     if (limits_group.isNull())
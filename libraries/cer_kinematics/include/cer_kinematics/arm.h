@@ -24,10 +24,155 @@
 #include <yarp/sig/Matrix.h>
 
 #include <cer_kinematics/utils.h>
+#include <cer_kinematics/reachability.h>
+#include <cer_kinematics/seeds.h>
 
 namespace cer {
 namespace kinematics {
 
+struct ArmSolverCache;
+
+/**
+ * Struct to report on the quality of the solution delivered by 
+ * the arm solver. 
+ */
+struct ArmSolverQuality
+{
+    /**
+     * the end-effector position error ([m]).
+     */
+    double position_error;
+
+    /**
+     * the end-effector orientation error ([rad]).
+     */
+    double orientation_error;
+
+    /**
+     * the maximum violation of the constraints.
+     */
+    double constraint_violation;
+
+    /**
+     * the number of iterations used.
+     */
+    int iterations;
+
+    /**
+     * true if the solver did not converge and the best feasible 
+     * iterate found within the deadline has been returned.
+     */
+    bool best_so_far;
+
+    /**
+     * Constructor.
+     */
+    ArmSolverQuality() : position_error(0.0), orientation_error(0.0),
+                         constraint_violation(0.0), iterations(0),
+                         best_so_far(false) { }
+};
+
+/**
+ * Struct to collect the statistics of one solution delivered by 
+ * the arm solver. 
+ */
+struct ArmSolverStats
+{
+    /**
+     * the number of evaluations of the cost function.
+     */
+    int eval_f_calls;
+
+    /**
+     * the number of evaluations of the cost gradient.
+     */
+    int eval_grad_f_calls;
+
+    /**
+     * the number of evaluations of the constraints.
+     */
+    int eval_g_calls;
+
+    /**
+     * the number of evaluations of the constraints Jacobian.
+     */
+    int eval_jac_g_calls;
+
+    /**
+     * the number of evaluations of the Lagrangian Hessian.
+     */
+    int eval_h_calls;
+
+    /**
+     * the time spent evaluating the cost function ([s]).
+     */
+    double eval_f_time;
+
+    /**
+     * the time spent evaluating the cost gradient ([s]).
+     */
+    double eval_grad_f_time;
+
+    /**
+     * the time spent evaluating the constraints ([s]).
+     */
+    double eval_g_time;
+
+    /**
+     * the time spent evaluating the constraints Jacobian ([s]).
+     */
+    double eval_jac_g_time;
+
+    /**
+     * the time spent evaluating the Lagrangian Hessian ([s]).
+     */
+    double eval_h_time;
+
+    /**
+     * the time spent within Ipopt outside the evaluations, mostly 
+     * in the linear algebra ([s]).
+     */
+    double ipopt_time;
+
+    /**
+     * the overall solving time ([s]).
+     */
+    double total_time;
+
+    /**
+     * the number of iterations used.
+     */
+    int iterations;
+
+    /**
+     * the solver's exit code.
+     */
+    int exit_code;
+
+    /**
+     * the maximum violation of the constraints.
+     */
+    double constraint_violation;
+
+    /**
+     * true if the solver was warm started.
+     */
+    bool warm_start;
+
+    /**
+     * Constructor.
+     */
+    ArmSolverStats() : eval_f_calls(0), eval_grad_f_calls(0),
+                       eval_g_calls(0), eval_jac_g_calls(0),
+                       eval_h_calls(0), eval_f_time(0.0),
+                       eval_grad_f_time(0.0), eval_g_time(0.0),
+                       eval_jac_g_time(0.0), eval_h_time(0.0),
+                       ipopt_time(0.0), total_time(0.0),
+                       iterations(0), exit_code(0),
+                       constraint_violation(0.0),
+                       warm_start(false) { }
+};
+
 /**
  * Class to handle direct and inverse kinematics of the robot 
  * arm. 
@@ -43,11 +188,26 @@ protected:
     yarp::sig::Vector zL;
     yarp::sig::Vector zU;
     yarp::sig::Vector lambda;
+    yarp::sig::Vector prevQ;
     int curMode;
+    int fkinCacheSize;
+    double fkinCacheTol;
+    std::deque<ReachabilityMap> reachMaps;
+    bool reachClamp;
+    SeedLibrary *seedLibrary;
+    bool seedLearn;
+    int statsSize;
+
+    ArmSolverCache *cache;
 
     friend class ArmCommonNLP;
 
     int computeMode() const;
+    ArmSolverCache& getCache();
+    bool screenTarget(yarp::sig::Matrix &Hd) const;
+    bool solve(const yarp::sig::Matrix &Hd, yarp::sig::Vector &q,
+               int *exit_code, const double deadline,
+               ArmSolverQuality *quality, ArmSolverStats *stats=NULL);
 
 public:
     /**
@@ -62,15 +222,29 @@ public:
               const SolverParameters &slvParams=SolverParameters(),
               const int verb=0);
 
+    /**
+     * Copy constructor. 
+     *  
+     * @param solver the solver to copy from. 
+     */
+    ArmSolver(const ArmSolver &solver);
+
+    /**
+     * Assignment operator. 
+     *  
+     * @param solver the solver to copy from. 
+     * @return a reference to the current object.
+     */
+    ArmSolver& operator=(const ArmSolver &solver);
+
     /**
      * Define parameters of the arm.
      * 
      * @param params arm parameters.
+     * @note the internal optimization problems are built anew 
+     *       at the next solver call.
      */
-    virtual void setArmParameters(const ArmParameters &params)
-    {
-        armParameters=params;
-    }
+    virtual void setArmParameters(const ArmParameters &params);
 
     /**
      * Retrieve parameters of the arm.
@@ -134,6 +308,153 @@ public:
     virtual bool fkin(const yarp::sig::Vector &q, yarp::sig::Matrix &H,
                       const int frame=-1);
 
+    /**
+     * Configure the cache of the most recent fkin() results, which 
+     * are looked up by DOFs values and frame. The cache is cleared 
+     * upon setArmParameters(). 
+     * 
+     * @param size   the maximum number of results kept (default=8); 
+     *               0 disables the cache.
+     * @param tol    the tolerance within which DOFs values are 
+     *               deemed equal ([m]-[deg]-[m]); 0 (default)
+     *               accounts for the exact match.
+     */
+    virtual void setFkinCache(const int size, const double tol=0.0);
+
+    /**
+     * Add a reachability map, which is used to screen the targets 
+     * before solving whenever it applies to the current arm, 
+     * solver parameters and target orientation. 
+     * 
+     * @param map    the reachability map.
+     * @note targets that are clearly unreachable according to the 
+     *       first applicable map make the Inverse Kinematics Law
+     *       fail at once with the initial guess as solution,
+     *       unless clamping is enabled.
+     */
+    virtual void addReachabilityMap(const ReachabilityMap &map);
+
+    /**
+     * Remove all the reachability maps.
+     */
+    virtual void clearReachabilityMaps();
+
+    /**
+     * Enable/disable the clamping of clearly unreachable targets.
+     * 
+     * @param clamp  if true, clearly unreachable targets are moved 
+     *               to the center of the nearest reachable voxel
+     *               and then solved for; otherwise (default), they
+     *               are rejected.
+     */
+    virtual void setReachabilityClamping(const bool clamp);
+
+    /**
+     * Enable the library of solved targets, which provides the 
+     * Inverse Kinematics Law with the initial guess whenever the 
+     * pose attained with the solution of the closest solved target 
+     * is nearer to the new target than the pose attained with the 
+     * current initial guess. When the torso is not optimized, the 
+     * seed retains the torso of the current initial guess.
+     * 
+     * @param library the library of solved targets; it is not 
+     *                copied, hence it must outlive the solver.
+     * @param learn   if true, the converged solutions are added to 
+     *                the library.
+     * @note the library is not queried in tracking mode nor by the 
+     *       multiple starts.
+     */
+    virtual void enableSeedLibrary(SeedLibrary &library,
+                                   const bool learn=false);
+
+    /**
+     * Disable the library of solved targets.
+     */
+    virtual void disableSeedLibrary();
+
+    /**
+     * Set the size of the buffer retaining the statistics of the 
+     * most recent solutions.
+     * 
+     * @param size   the number of solutions retained (default 100); 
+     *               0 disables the profiling of the solver.
+     * @note the content of the buffer is discarded.
+     */
+    virtual void setStatsBufferSize(const int size);
+
+    /**
+     * Retrieve the statistics of the most recent solutions.
+     * 
+     * @param stats  the statistics, the oldest first.
+     */
+    virtual void getStats(std::deque<ArmSolverStats> &stats) const;
+
+    /**
+     * Compute the percentile of the statistics of the most recent 
+     * solutions.
+     * 
+     * @param p      the percentile in [0,100].
+     * @param stats  the statistics, each field of which holds its 
+     *               own percentile; exit_code and warm_start are
+     *               not filled in.
+     * @return true/false on success/failure, which occurs if the 
+     *         buffer is empty.
+     */
+    virtual bool getStatsPercentile(const double p, ArmSolverStats &stats) const;
+
+    /**
+     * Print out the median, the 90th and the 99th percentiles of 
+     * the statistics of the most recent solutions along with the
+     * rates of convergence and warm starts.
+     */
+    virtual void printStats() const;
+
+    /**
+     * Discard the statistics of the most recent solutions.
+     */
+    virtual void clearStats();
+
+    /**
+     * Retrieve the statistics of the fkin() cache.
+     * 
+     * @param hits   the number of lookups served by the cache.
+     * @param misses the number of lookups that required the 
+     *               computation.
+     */
+    virtual void getFkinCacheStats(unsigned int &hits,
+                                   unsigned int &misses) const;
+
+    /**
+     * Forward Kinematics Law of all the frames in one pass.
+     * 
+     * @param q      the DOFs values ([m]-[deg]-[m]).
+     * @param H      the 4-by-4 homogeneous matrices ([m]) of the 
+     *               frames, in the order: torso platform, each link
+     *               of the upper_arm, lower_arm platform and
+     *               end-effector (nDOF_upper_arm+3 items).
+     * @return true/false on success/failure.
+     * @note H[0], H[1+i] and H[1+nDOF_upper_arm] are the frames 
+     *       returned by fkin() for frame=0, frame=3+i and frame=9
+     *       respectively.
+     */
+    virtual bool fkinAll(const yarp::sig::Vector &q,
+                         std::deque<yarp::sig::Matrix> &H);
+
+    /**
+     * Geometric Jacobian.
+     * 
+     * @param q      the DOFs values ([m]-[deg]-[m]).
+     * @param J      the 6-by-12 geometric Jacobian of the origin of 
+     *               the specified frame, expressed in the root frame
+     *               and computed in closed form; columns of the
+     *               revolute joints refer to [rad].
+     * @param frame  specify the DOF number whose frame is 
+     *               considered, as in fkin().
+     * @return true/false on success/failure.
+     */
+    virtual bool jacobian(const yarp::sig::Vector &q, yarp::sig::Matrix &J,
+                          const int frame=-1);
+
     /**
      * Inverse Kinematics Law.
      * 
@@ -146,10 +467,137 @@ public:
     virtual bool ikin(const yarp::sig::Matrix &Hd, yarp::sig::Vector &q,
                       int *exit_code=NULL);
 
+    /**
+     * Inverse Kinematics Law solved within a hard deadline. 
+     * 
+     * @param Hd        the desired 4-by-4 homogeneous matrix 
+     *                  representing the end-effector frame ([m]).
+     * @param q         the solved DOFs ([m]-[deg]-[m]). 
+     * @param deadline  the absolute time ([s]), as given by 
+     *                  yarp::os::Time::now(), by which the solver
+     *                  has to return.
+     * @param quality   the quality report of the returned DOFs.
+     * @param exit_code pointer to solver's exit codes. 
+     * @return true if the solver converged, false otherwise. 
+     * @note the solver keeps track of the iterate with the lowest 
+     *       pose error that satisfies the tilt constraints and
+     *       returns it whenever it does not converge in time. The
+     *       solver stops as soon as the next iteration is expected
+     *       to overrun the deadline. The time spent waiting for a
+     *       non-reentrant linear solver counts against the deadline
+     *       too, and the initial guess is returned if none is left.
+     */
+    virtual bool ikin(const yarp::sig::Matrix &Hd, yarp::sig::Vector &q,
+                      const double deadline, ArmSolverQuality &quality,
+                      int *exit_code=NULL);
+
+    /**
+     * Inverse Kinematics Law reporting on the solution statistics.
+     * 
+     * @param Hd        the desired 4-by-4 homogeneous matrix 
+     *                  representing the end-effector frame ([m]).
+     * @param q         the solved DOFs ([m]-[deg]-[m]). 
+     * @param stats     the statistics of the solution.
+     * @param exit_code pointer to solver's exit codes. 
+     * @return true/false on success/failure.
+     * @note the statistics are collected even if the buffer is 
+     *       disabled.
+     */
+    virtual bool ikin(const yarp::sig::Matrix &Hd, yarp::sig::Vector &q,
+                      ArmSolverStats &stats, int *exit_code=NULL);
+
+    /**
+     * Differential Inverse Kinematics Law, meant for high-rate 
+     * control loops where the target moves only slightly between
+     * two consecutive calls.
+     * 
+     * @param Hd        the desired 4-by-4 homogeneous matrix 
+     *                  representing the end-effector frame ([m]).
+     * @param q         the current DOFs ([m]-[deg]-[m]).
+     * @param q_next    the DOFs after one damped least-squares step 
+     *                  toward the target ([m]-[deg]-[m]); (q_next-q)
+     *                  divided by the control period yields the
+     *                  DOFs velocities.
+     * @param damping   the damping factor of the least-squares.
+     * @return true/false on success/failure.
+     * @note the step relies on the Jacobian of the whole chain 
+     *       (tripod, upper_arm and tripod) and accounts for the
+     *       heave tasks prescribed by the current configuration.
+     *       DOFs hitting their bounds are clamped, while the
+     *       elongations of the tripods exceeding the maximum tilt
+     *       are shrunk toward their mean. Configurations without
+     *       torso keep the torso DOFs as in q.
+     */
+    virtual bool ikinDiff(const yarp::sig::Matrix &Hd, const yarp::sig::Vector &q,
+                          yarp::sig::Vector &q_next, const double damping=0.01);
+
+    /**
+     * Inverse Kinematics Law solved concurrently from multiple 
+     * initial guesses. 
+     * 
+     * @param Hd        the desired 4-by-4 homogeneous matrix 
+     *                  representing the end-effector frame ([m]).
+     * @param q         the solved DOFs ([m]-[deg]-[m]). 
+     * @param starts    the number of initial guesses: the current 
+     *                  initial guess, the midpoints of the joints
+     *                  ranges and random configurations within the
+     *                  bounds.
+     * @param exit_code pointer to solver's exit codes. 
+     * @return true/false on success/failure.
+     * @note as soon as one start converges, the others are 
+     *       stopped; the solution with the lowest pose error plus
+     *       constraints violation is then returned. With a linear
+     *       solver that is not reentrant (i.e. MUMPS), the starts
+     *       are run in turn beginning from the current initial
+     *       guess. The solvers of the pool are the same as
+     *       ikinBatch(), although here they do not resort to the
+     *       seed library.
+     */
+    virtual bool ikinMultiStart(const yarp::sig::Matrix &Hd, yarp::sig::Vector &q,
+                                const int starts=4, int *exit_code=NULL);
+
+    /**
+     * Inverse Kinematics Law solved for a batch of independent 
+     * targets, which are spread across a pool of solvers running 
+     * concurrently. 
+     * 
+     * @param Hd         the desired 4-by-4 homogeneous matrices 
+     *                   representing the end-effector frames ([m]).
+     * @param q          the solved DOFs ([m]-[deg]-[m]), in the same
+     *                   order as Hd.
+     * @param exit_codes the solver's exit codes, in the same order 
+     *                   as Hd.
+     * @param timings    the solving times ([s]), in the same order 
+     *                   as Hd.
+     * @param heave      if not empty, the torso heave ([m]) to be 
+     *                   used for each target in place of the one of
+     *                   the solver parameters.
+     * @param q0         if not empty, the initial DOFs values 
+     *                   ([m]-[deg]-[m]) for each target; otherwise,
+     *                   the current initial guess is used.
+     * @param workers    the number of solvers in the pool.
+     * @return true if all the targets have been solved 
+     *         successfully, false otherwise.
+     * @note the solvers of the pool are clones of the current 
+     *       object that persist across calls; they do not warm
+     *       start and do not trigger the iterate callback, whereas
+     *       they share the seed library of the current object at
+     *       the time of the call. Solvers
+     *       run truly in parallel only if Ipopt relies on a
+     *       reentrant linear solver (i.e. not MUMPS).
+     */
+    virtual bool ikinBatch(const std::deque<yarp::sig::Matrix> &Hd,
+                           std::deque<yarp::sig::Vector> &q,
+                           std::deque<int> &exit_codes,
+                           std::deque<double> &timings,
+                           const std::deque<double> &heave=std::deque<double>(),
+                           const std::deque<yarp::sig::Vector> &q0=std::deque<yarp::sig::Vector>(),
+                           const int workers=4);
+
     /**
      * Destructor.
      */
-    virtual ~ArmSolver() { }
+    virtual ~ArmSolver();
 };
 
 
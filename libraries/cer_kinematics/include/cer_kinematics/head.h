@@ -18,6 +18,10 @@
 #ifndef __CER_KINEMATICS_HEAD_H__
 #define __CER_KINEMATICS_HEAD_H__
 
+#include <string>
+#include <deque>
+#include <map>
+
 #include <yarp/sig/Vector.h>
 #include <yarp/sig/Matrix.h>
 
@@ -40,6 +44,7 @@ protected:
     SolverParameters slvParameters;
     TripodSolver torso;
     yarp::sig::Vector q0;
+    std::map<std::string,HeadParameters> branches;
 
     friend class HeadNLP;
 
@@ -70,6 +75,19 @@ public:
      */
     virtual void setHeadParameters(const HeadParameters &params);
 
+    /**
+     * Define the parameters used by fkinAll() for the branch of the
+     * head type given by params, e.g. to honour the robot joints
+     * bounds of a type other than the current one.
+     * 
+     * @param params head parameters of the branch.
+     * @note the branch of the current type follows always the 
+     *       current parameters, whereas the branches left
+     *       unspecified resort to the default parameters of their
+     *       types.
+     */
+    virtual void setBranchParameters(const HeadParameters &params);
+
     /**
      * Retrieve parameters of the head.
      * 
@@ -132,6 +150,40 @@ public:
     virtual bool fkin(const yarp::sig::Vector &q, yarp::sig::Matrix &H,
                       const int frame=-1);
 
+    /**
+     * Forward Kinematics Law of the end-effectors of all the head 
+     * types in one pass.
+     * 
+     * @param q      the DOFs values ([m]-[deg]).
+     * @param H      the 4-by-4 homogeneous matrices of the 
+     *               end-effectors ([m]), indexed by the types given
+     *               by HeadParameters::getTypes().
+     * @return true/false on success/failure.
+     * @note the torso and the links shared by all the types are 
+     *       evaluated once according to the current parameters;
+     *       the computation then branches to the last link of each
+     *       type, where the current type follows the current
+     *       parameters too, while the others follow the parameters
+     *       given by setBranchParameters().
+     */
+    virtual bool fkinAll(const yarp::sig::Vector &q,
+                         std::map<std::string,yarp::sig::Matrix> &H);
+
+    /**
+     * Geometric Jacobian.
+     * 
+     * @param q      the DOFs values ([m]-[deg]).
+     * @param J      the 6-by-nDOF geometric Jacobian of the origin 
+     *               of the specified frame, expressed in the root
+     *               frame and computed in closed form; columns of
+     *               the revolute joints refer to [rad].
+     * @param frame  specify the DOF number whose frame is 
+     *               considered, as in fkin().
+     * @return true/false on success/failure.
+     */
+    virtual bool jacobian(const yarp::sig::Vector &q, yarp::sig::Matrix &J,
+                          const int frame=-1);
+
     /**
      * Inverse Kinematics Law.
      *  
@@ -139,6 +191,10 @@ public:
      * @param q         the solved head DOFs ([deg]). 
      * @param exit_code pointer to solver's exit codes.  
      * @return true/false on success/failure.
+     *  
+     * @note The problem is first tackled with a few projected 
+     *       Newton iterations within the neck bounds, whereas
+     *       Ipopt is resorted to only when those do not converge.
      */
     virtual bool ikin(const yarp::sig::Vector &xd, yarp::sig::Vector &q,
                       int *exit_code=NULL);
@@ -155,6 +211,34 @@ public:
     virtual bool ikin(const yarp::sig::Matrix &Hd, yarp::sig::Vector &q,
                       int *exit_code=NULL);
 
+    /**
+     * Inverse Kinematics Law solved for a batch of independent 
+     * fixation points, which are spread across a pool of solvers 
+     * running concurrently. 
+     *  
+     * @param xd         the desired 3D fixation points ([m]).
+     * @param q          the solved head DOFs ([deg]), in the same 
+     *                   order as xd.
+     * @param exit_codes the solver's exit codes, in the same order 
+     *                   as xd.
+     * @param timings    the solving times ([s]), in the same order 
+     *                   as xd.
+     * @param q0         if not empty, the initial DOFs values 
+     *                   ([m]-[deg]) for each target; otherwise, the
+     *                   current initial guess is used.
+     * @param workers    the number of solvers in the pool.
+     * @return true if all the targets have been solved 
+     *         successfully, false otherwise.
+     * @note the solvers of the pool are clones of the current 
+     *       object that do not trigger the iterate callback.
+     */
+    virtual bool ikinBatch(const std::deque<yarp::sig::Vector> &xd,
+                           std::deque<yarp::sig::Vector> &q,
+                           std::deque<int> &exit_codes,
+                           std::deque<double> &timings,
+                           const std::deque<yarp::sig::Vector> &q0=std::deque<yarp::sig::Vector>(),
+                           const int workers=4);
+
     /**
      * Destructor.
      */
@@ -33,22 +33,51 @@ protected:
     double wpostural_torso_yaw;
     double wpostural_upper_arm;
     double wpostural_lower_arm;
+    bool use_hessian;
+    bool full_pose;
+    bool fixed_torso;
+    bool fixed_heave;
 
-    Matrix H0,HN,Hd,Rd;
-    Vector x0,x;
+    Matrix Hd,Rd;
+    Vector x0,x,xm;
     Vector xd,ud;
 
     Vector latch_x;
+    bool latched;
     VectorOf<int> latch_idx;
     Vector latch_gl,latch_gu;
 
     Vector zL,zU;
     Vector lambda;
 
-    TripodState d1,d2;
-    TripodState din1,din2;
-    Matrix H,H_,J_,T;
-    Vector q;
+    CancellationToken *cancellation;
+    double cost,violation;
+
+    // anytime mode: best iterate complying with the tilt constraints
+    double deadline,t_start;
+    int iterations;
+    Vector x_best;
+    bool found_best;
+    double e_best,violation_best;
+
+    Matrix T;
+
+    // fixed-size quantities the callbacks rely on to avoid heap
+    // allocations while iterating
+    struct FixedQuantities
+    {
+        double A[6],D[6],alpha[6],offset[6];
+        fixed::Hom4 H0,HN,TN;
+        fixed::Mat3 Rd;
+        fixed::Vec3 xd;
+        TripodFrame d1,d2;
+        TripodFrame din1,din2;
+        fixed::Hom4 H,M,T;
+    } quantities;
+
+    bool new_derivatives;
+    TripodJacobian Jin1,Jin2;
+    double jw[12][3],jv[12][3];
 
     /****************************************************************/
     TripodState tripod_fkin(const int which, const Ipopt::Number *x,
@@ -57,60 +86,150 @@ protected:
         const TripodParametersExtended &params=((which==1)?torso:lower_arm);
         int offs=(which==1)?0:9;
 
-        double q33=sqrt(27.0)*params.r/sqrt(12.0*(x[offs+2]*x[offs+2]-(x[offs+0]+x[offs+1])*x[offs+2]+
-                                            x[offs+1]*x[offs+1]-x[offs+0]*x[offs+1]+x[offs+0]*x[offs+0]+
-                                            (27.0/12.0)*params.r*params.r));
+        TripodFrame d,din;
+        params.kernel.fkin(x+offs,d,&din);
+        if (internal!=NULL)
+            *internal=din;
+
+        TripodState state;
+        state=d;
+        return state;
+    }
+
+    /****************************************************************/
+    double dot3(const fixed::Vec3 &a, const double *b) const
+    {
+        return a[0]*b[0]+a[1]*b[1]+a[2]*b[2];
+    }
+
+    /****************************************************************/
+    fixed::Vec3 orientation_error() const
+    {
+        return fixed::dcm2rotvec(quantities.Rd*transposed(quantities.T.rotation()));
+    }
+
+    /****************************************************************/
+    fixed::Vec3 position_error() const
+    {
+        return quantities.xd-quantities.T.position();
+    }
+
+    /****************************************************************/
+    bool verify_tilt() const
+    {
+        // the torso is subject to the constraint only when it moves
+        if (!fixed_torso && (quantities.din1.n[2]<torso.cos_alpha_max))
+            return false;
 
-        TripodState d;
-        if (q33>=1.0)
+        return (quantities.din2.n[2]>=lower_arm.cos_alpha_max);
+    }
+
+    /****************************************************************/
+    void limit_tilt(const TripodParametersExtended &params, double *l) const
+    {
+        TripodFrame d,din;
+        params.kernel.fkin(l,d,&din);
+        if (din.n[2]>=params.cos_alpha_max)
+            return;
+
+        double m=(l[0]+l[1]+l[2])/3.0;
+        double l0[3]={l[0]-m,l[1]-m,l[2]-m};
+
+        // bisection on the shrinking factor
+        double s_lo=0.0,s_hi=1.0;
+        for (int i=0; i<20; i++)
         {
-            d.n=params.z;
-            d.u=0.0;
-            d.p[0]=d.p[1]=0.0;
-            d.p[2]=d.T(2,3)=x[offs+0];
+            double s=0.5*(s_lo+s_hi);
+            for (int k=0; k<3; k++)
+                l[k]=m+s*l0[k];
+
+            params.kernel.fkin(l,d,&din);
+            if (din.n[2]>=params.cos_alpha_max)
+                s_lo=s;
+            else
+                s_hi=s;
         }
-        else
+
+        for (int k=0; k<3; k++)
+            l[k]=m+s_lo*l0[k];
+    }
+
+    /****************************************************************/
+    void hessian_structure(Ipopt::Index n, Ipopt::Index *iRow, Ipopt::Index *jCol)
+    {
+        // dense lower triangular part
+        Ipopt::Index idx=0;
+        for (Ipopt::Index row=0; row<n; row++)
         {
-            Vector v1=params.s[0]+x[offs+0]*params.z;
-            Vector v2=params.s[1]+x[offs+1]*params.z;
-            Vector v3=params.s[2]+x[offs+2]*params.z;
-            d.n=cross(v2-v1,v3-v1);
-            d.n/=norm(d.n);
-
-            double sin_theta=sqrt(1.0-q33*q33);
-            d.u[0]=-d.n[1]/sin_theta;
-            d.u[1]=d.n[0]/sin_theta;
-            d.u[2]=0.0;
-            d.u[3]=acos(q33);
-            double tmp=(1.0-q33);
-            double q11=tmp*d.u[0]*d.u[0]+q33;
-            double q22=tmp*d.u[1]*d.u[1]+q33;
-            double q21=tmp*d.u[0]*d.u[1];
-            double q31=-sin_theta*d.u[1];
-            double q32=sin_theta*d.u[0];
-            double m1=params.r/q33*(-0.5*q11+1.5*q22);
-            d.p[0]=params.r-m1*q11;
-            d.p[1]=-m1*q21;
-            d.p[2]=x[offs+0]-m1*q31;
-
-            // transformation matrix
-            d.T(0,0)=q11; d.T(0,1)=q21; d.T(0,2)=-q31; d.T(0,3)=d.p[0];
-            d.T(1,0)=q21; d.T(1,1)=q22; d.T(1,2)=-q32; d.T(1,3)=d.p[1];
-            d.T(2,0)=q31; d.T(2,1)=q32; d.T(2,2)=q33;  d.T(2,3)=d.p[2];
+            for (Ipopt::Index col=0; col<=row; col++)
+            {
+                iRow[idx]=row; jCol[idx]=col;
+                idx++;
+            }
         }
+    }
 
-        if (internal!=NULL)
-            *internal=d;
+    /****************************************************************/
+    void hessian_postural(Ipopt::Index n, Ipopt::Number obj_factor,
+                          const bool torso_too, Ipopt::Number *values)
+    {
+        Ipopt::Index nele=(n*(n+1))>>1;
+        for (Ipopt::Index i=0; i<nele; i++)
+            values[i]=0.0;
+
+        // values[(row*(row+1))/2+col] holds the element (row,col)
+        if (torso_too)
+        {
+            double w=2.0*obj_factor*wpostural_torso;
+            values[0]+=w;
+            values[1]-=w; values[2]+=2.0*w;
+            values[4]-=w; values[5]+=w;
+
+            values[9]+=2.0*obj_factor*wpostural_torso_yaw;
+        }
 
-        d.n=params.R0*d.n;
-        d.p=params.R0*d.p+params.p0;
-        d.T=params.T0*d.T;
+        for (size_t i=1; i<upper_arm.getDOF(); i++)
+        {
+            size_t row=3+i;
+            values[((row*(row+1))>>1)+row]+=2.0*obj_factor*wpostural_upper_arm;
+        }
+
+        double w=2.0*obj_factor*wpostural_lower_arm;
+        values[54]+=w;
+        values[64]-=w; values[65]+=2.0*w;
+        values[76]-=w; values[77]+=w;
+    }
+
+    /****************************************************************/
+    void hessian_add(const double j[12][3], const double w, Ipopt::Number *values) const
+    {
+        // Gauss-Newton contribution w*J'*J of a 3D residual whose
+        // Jacobian J has the columns j[0],...,j[11]
+        if (w==0.0)
+            return;
+
+        Ipopt::Index idx=0;
+        for (int row=0; row<12; row++)
+            for (int col=0; col<=row; col++)
+                values[idx++]+=w*(j[row][0]*j[col][0]+j[row][1]*j[col][1]+
+                                  j[row][2]*j[col][2]);
+    }
 
-        double theta=d.u[3];
-        d.u=params.R0*d.u.subVector(0,2);
-        d.u.push_back(theta);
+    /****************************************************************/
+    void hessian_add_heave(const int offs, const TripodJacobian &Jin,
+                           const double w, Ipopt::Number *values) const
+    {
+        // same as above for the heave of a tripod, which affects
+        // only the block of its own elongations
+        if (w==0.0)
+            return;
 
-        return d;
+        for (int r=0; r<3; r++)
+        {
+            int row=offs+r;
+            for (int c=0; c<=r; c++)
+                values[((row*(row+1))>>1)+offs+c]+=w*Jin.dp[r][2]*Jin.dp[c][2];
+        }
     }
 
     /****************************************************************/
@@ -135,11 +254,9 @@ protected:
     {
         if (verify_alpha(x,g))
         {
-            if (latch_x.length()==0)
-                latch_x.resize(n);
-
             for (Ipopt::Index i=0; i<n; i++)
                 latch_x[i]=x[i];
+            latched=true;
         }        
     }
 
@@ -157,7 +274,7 @@ protected:
             Ipopt::Number *g=(Ipopt::Number*)g_data.data();
 
             eval_g(n,x,true,m,g);
-            if (!verify_alpha(x,g) && (latch_x.length()>0))
+            if (!verify_alpha(x,g) && latched)
                 solution=latch_x;
         }
 
@@ -176,22 +293,47 @@ public:
                  wpostural_torso(slv_.slvParameters.weight_postural_torso),
                  wpostural_torso_yaw(slv_.slvParameters.weight_postural_torso_yaw),
                  wpostural_upper_arm(slv_.slvParameters.weight_postural_upper_arm),
-                 wpostural_lower_arm(slv_.slvParameters.weight_postural_lower_arm)
+                 wpostural_lower_arm(slv_.slvParameters.weight_postural_lower_arm),
+                 use_hessian(slv_.slvParameters.use_hessian),
+                 full_pose(slv_.slvParameters.full_pose),
+                 fixed_torso((slv_.slvParameters.configuration==configuration::no_torso_no_heave) ||
+                             (slv_.slvParameters.configuration==configuration::no_torso_heave)),
+                 fixed_heave((slv_.slvParameters.configuration==configuration::no_heave) ||
+                             (slv_.slvParameters.configuration==configuration::no_torso_no_heave))
     {
         drho=DELTA_RHO;
-
-        H0=upper_arm.getH0();
-        HN=upper_arm.getHN();
+        latched=false;
+        new_derivatives=true;
+        cancellation=NULL;
+        cost=violation=0.0;
+        deadline=-1.0;
+        t_start=0.0;
+        iterations=0;
+        found_best=false;
+        e_best=violation_best=0.0;
+
+        quantities.H0=fixed::Hom4(upper_arm.getH0());
+        quantities.HN=fixed::Hom4(upper_arm.getHN());
+        quantities.TN=fixed::Hom4(TN);
 
         x0.resize(12,0.0);
 
         iKinChain *chain=upper_arm.asChain();
         for (size_t i=0; i<upper_arm.getDOF(); i++)
+        {
             x0[3+i]=0.5*((*chain)[i].getMin()+(*chain)[i].getMax());
+
+            quantities.A[i]=(*chain)[i].getA();
+            quantities.D[i]=(*chain)[i].getD();
+            quantities.alpha[i]=(*chain)[i].getAlpha();
+            quantities.offset[i]=(*chain)[i].getOffset();
+        }
         
-        x=x0;
+        x=xm=x_best=x0;
         set_target(eye(4,4));
-        q=x0.subVector(3,3+upper_arm.getDOF()-1);
+
+        // the output is sized once here and then filled in place
+        T=eye(4,4);
     }
 
     /****************************************************************/
@@ -250,6 +392,18 @@ public:
         this->x0[11]=std::max(lower_arm.l_min,std::min(lower_arm.l_max,x0[11]));
     }
 
+    /****************************************************************/
+    virtual void set_solver_parameters(const SolverParameters &params)
+    {
+        hd1=params.torso_heave;
+        hd2=params.lower_arm_heave;
+        wpostural_torso=params.weight_postural_torso;
+        wpostural_torso_yaw=params.weight_postural_torso_yaw;
+        wpostural_upper_arm=params.weight_postural_upper_arm;
+        wpostural_lower_arm=params.weight_postural_lower_arm;
+        use_hessian=params.use_hessian;
+    }
+
     /****************************************************************/
     virtual void set_target(const Matrix &Hd)
     {
@@ -260,6 +414,13 @@ public:
         Rd(0,3)=Rd(1,3)=Rd(2,3)=0.0;
 
         ud=dcm2axis(Rd);
+
+        for (int i=0; i<3; i++)
+        {
+            quantities.xd[i]=xd[i];
+            for (int j=0; j<3; j++)
+                quantities.Rd(i,j)=Rd(i,j);
+        }
     }
 
     /****************************************************************/
@@ -272,6 +433,192 @@ public:
         return x_;
     }
 
+    /****************************************************************/
+    virtual Vector get_midpoints() const
+    {
+        Vector x_=xm;
+        for (size_t i=0; i<upper_arm.getDOF(); i++)
+            x_[3+i]*=CTRL_RAD2DEG;
+
+        return x_;
+    }
+
+    /****************************************************************/
+    virtual void set_cancellation(CancellationToken *cancellation)
+    {
+        this->cancellation=cancellation;
+    }
+
+    /****************************************************************/
+    virtual void get_merit(double &cost, double &violation) const
+    {
+        cost=this->cost;
+        violation=this->violation;
+    }
+
+    /****************************************************************/
+    virtual Vector predict_q0(const Vector &q, const Vector &q0)
+    {
+        return differential_step(q,q0,1e-2);
+    }
+
+    /****************************************************************/
+    virtual Vector differential_step(const Vector &q, const Vector &q0,
+                                     const double damping)
+    {
+        // damped least-squares step toward the current target, with
+        // the kinematics linearized at q ([m]-[deg]-[m])
+        Vector x_=q.subVector(0,11);
+        for (size_t i=0; i<upper_arm.getDOF(); i++)
+            x_[3+i]*=CTRL_DEG2RAD;
+        computeDerivatives((Ipopt::Number*)x_.data(),true);
+
+        // tasks: pose and, if prescribed, heaves
+        bool heave1=fixed_heave && !fixed_torso;
+        bool heave2=fixed_heave;
+        int rows=(full_pose?6:3)+(heave1?1:0)+(heave2?1:0);
+        Matrix J(rows,12);
+        Vector e(rows);
+        J.zero();
+
+        fixed::Vec3 ex=position_error();
+        fixed::Vec3 eo=orientation_error();
+        int r=0;
+        for (int j=0; j<3; j++, r++)
+        {
+            for (int i=0; i<12; i++)
+                J(r,i)=jv[i][j];
+            e[r]=ex[j];
+        }
+
+        if (full_pose)
+        {
+            for (int j=0; j<3; j++, r++)
+            {
+                for (int i=0; i<12; i++)
+                    J(r,i)=jw[i][j];
+                e[r]=eo[j];
+            }
+        }
+
+        if (heave1)
+        {
+            for (int k=0; k<3; k++)
+                J(r,k)=Jin1.dp[k][2];
+            e[r++]=hd1-quantities.din1.p[2];
+        }
+
+        if (heave2)
+        {
+            for (int k=0; k<3; k++)
+                J(r,9+k)=Jin2.dp[k][2];
+            e[r++]=hd2-quantities.din2.p[2];
+        }
+
+        // bounds
+        Vector x_min(12),x_max(12);
+        iKinChain *chain=upper_arm.asChain();
+        for (int k=0; k<3; k++)
+        {
+            x_min[k]=torso.l_min;         x_max[k]=torso.l_max;
+            x_min[9+k]=lower_arm.l_min;   x_max[9+k]=lower_arm.l_max;
+        }
+        for (size_t i=0; i<upper_arm.getDOF(); i++)
+        {
+            x_min[3+i]=(*chain)[i].getMin();
+            x_max[3+i]=(*chain)[i].getMax();
+        }
+
+        // torso and torso yaw are given by q0 when not optimized
+        VectorOf<int> locked(12);
+        for (int i=0; i<12; i++)
+            locked[i]=(fixed_torso && (i<4))?1:0;
+
+        // variables hitting the bounds are clamped and then removed
+        // from the set the residual task is distributed upon
+        Vector dx(12,0.0);
+        for (int pass=0; pass<12; pass++)
+        {
+            Matrix Jf=J;
+            for (int i=0; i<12; i++)
+            {
+                if (locked[i]!=0)
+                    Jf.setCol(i,Vector(rows,0.0));
+                else
+                    dx[i]=0.0;
+            }
+
+            Vector ef=e-J*dx;
+            Vector dxf=Jf.transposed()*luinv(Jf*Jf.transposed()+
+                                             (damping*damping)*eye(rows,rows))*ef;
+
+            bool clamped=false;
+            for (int i=0; i<12; i++)
+            {
+                if (locked[i]!=0)
+                    continue;
+
+                dx[i]=dxf[i];
+                double xi=x_[i]+dx[i];
+                if ((xi<x_min[i]) || (xi>x_max[i]))
+                {
+                    dx[i]=std::max(x_min[i],std::min(x_max[i],xi))-x_[i];
+                    locked[i]=1;
+                    clamped=true;
+                }
+            }
+
+            if (!clamped)
+                break;
+        }
+
+        Vector xn=x_+dx;
+
+        // the tilt is recovered by shrinking the elongations toward
+        // their mean, which leaves the heave about unaltered
+        if (!fixed_torso)
+            limit_tilt(torso,&xn[0]);
+        limit_tilt(lower_arm,&xn[9]);
+
+        for (size_t i=0; i<upper_arm.getDOF(); i++)
+            xn[3+i]*=CTRL_RAD2DEG;
+
+        if (fixed_torso)
+            for (int i=0; i<4; i++)
+                xn[i]=q0[i];
+
+        return xn;
+    }
+
+    /****************************************************************/
+    virtual void set_deadline(const double deadline)
+    {
+        this->deadline=deadline;
+        t_start=Time::now();
+        iterations=0;
+        found_best=false;
+    }
+
+    /****************************************************************/
+    virtual bool get_best(Vector &x_best, double &violation) const
+    {
+        if (!found_best)
+            return false;
+
+        x_best=this->x_best;
+        for (size_t i=0; i<upper_arm.getDOF(); i++)
+            x_best[3+i]*=CTRL_RAD2DEG;
+
+        violation=violation_best;
+        return true;
+    }
+
+    /****************************************************************/
+    virtual int get_iterations() const
+    {
+        return iterations;
+    }
+
     /****************************************************************/
     virtual void set_warm_start(const Vector &zL, const Vector &zU,
                                 const Vector &lambda)
@@ -298,6 +645,11 @@ public:
         {
             for (Ipopt::Index i=0; i<n; i++)
                 x[i]=x0[i];
+
+            // the object is reused across solver calls
+            if (latch_x.length()!=n)
+                latch_x.resize(n);
+            latched=false;
         }
 
         if (init_z)
@@ -328,18 +680,84 @@ public:
             for (size_t i=0; i<this->x.length(); i++)
                 this->x[i]=x[i];
 
-            for (size_t i=0; i<q.length(); i++)
-                q[i]=x[3+i];
+            FixedQuantities &Q=quantities;
+            torso.kernel.fkin(x,Q.d1,&Q.din1);
+            lower_arm.kernel.fkin(x+9,Q.d2,&Q.din2);
+            fixed::Hom4 T1(Q.d1.T),T2(Q.d2.T);
 
-            d1=tripod_fkin(1,x,&din1);
-            d2=tripod_fkin(2,x,&din2);
-            H=upper_arm.getH(q);
-            T=d1.T*H*d2.T*TN;
+            // upper_arm: z-axes and origins of the joints' frames
+            // collected while walking the DH chain
+            fixed::Vec3 z[6],o[6];
+            fixed::Hom4 G=Q.H0;
+            for (size_t i=0; i<upper_arm.getDOF(); i++)
+            {
+                z[i]=G.getCol(2);
+                o[i]=G.position();
+                G=G*fixed::dh(Q.A[i],Q.D[i],Q.alpha[i],x[3+i]+Q.offset[i]);
+            }
+
+            Q.H=G*Q.HN;
+            Q.M=T1*Q.H;
+            Q.T=Q.M*T2*Q.TN;
+
+            // geometric Jacobian of the upper_arm in the root frame,
+            // given that the downstream chain moves rigidly with it
+            fixed::Mat3 R1=T1.rotation();
+            fixed::Vec3 pe=Q.T.position();
+            fixed::Vec3 p1=T1.position();
+            for (size_t i=0; i<upper_arm.getDOF(); i++)
+            {
+                fixed::Vec3 zi=R1*z[i];
+                fixed::Vec3 vi=cross(zi,pe-(R1*o[i]+p1));
+                for (int j=0; j<3; j++)
+                {
+                    jv[3+i][j]=vi[j];
+                    jw[3+i][j]=zi[j];
+                }
+            }
 
-            upper_arm.setH0(d1.T*H0); upper_arm.setHN(HN*d2.T*TN);
-            H_=upper_arm.getH(q);
-            J_=upper_arm.GeoJacobian();
-            upper_arm.setH0(H0); upper_arm.setHN(HN);
+            // yarp mirror for the user callback
+            Q.T.toMatrix(T);
+
+            new_derivatives=true;
+        }
+    }
+
+    /************************************************************************/
+    virtual void computeDerivatives(const Ipopt::Number *x, const bool new_x)
+    {
+        computeQuantities(x,new_x);
+
+        if (new_derivatives)
+        {
+            // jw and jv hold the angular and linear velocity of the
+            // end-effector induced by each elongation (root frame)
+            TripodJacobian J1,J2;
+            torso.kernel.jacobian(x,J1,&Jin1);
+            lower_arm.kernel.jacobian(x+9,J2,&Jin2);
+
+            const FixedQuantities &Q=quantities;
+            fixed::Hom4 T2=fixed::Hom4(Q.d2.T)*Q.TN;
+
+            // torso: the end-effector in the root frame
+            double p1[3]={Q.T(0,3),Q.T(1,3),Q.T(2,3)};
+            TripodKernel::jacobian(Q.d1,J1,p1,jw,jv);
+
+            // lower_arm: the end-effector in the tripod frame, whose
+            // velocities are mapped through the upstream chain
+            double p2[3]={T2(0,3),T2(1,3),T2(2,3)};
+            double jw2[3][3],jv2[3][3];
+            TripodKernel::jacobian(Q.d2,J2,p2,jw2,jv2);
+            for (int k=0; k<3; k++)
+            {
+                for (int i=0; i<3; i++)
+                {
+                    jw[9+k][i]=Q.M(i,0)*jw2[k][0]+Q.M(i,1)*jw2[k][1]+Q.M(i,2)*jw2[k][2];
+                    jv[9+k][i]=Q.M(i,0)*jv2[k][0]+Q.M(i,1)*jv2[k][1]+Q.M(i,2)*jv2[k][2];
+                }
+            }
+
+            new_derivatives=false;
         }
     }
 
@@ -361,6 +779,38 @@ public:
                                Ipopt::Index ls_trials, const Ipopt::IpoptData* ip_data,
                                Ipopt::IpoptCalculatedQuantities* ip_cq)
     {
+        iterations=iter;
+
+        // another solver of the same pool got there first
+        if ((cancellation!=NULL) && cancellation->isCancelled())
+            return false;
+
+        if (deadline>=0.0)
+        {
+            // quantities refer to the iterate just accepted
+            if ((mode==Ipopt::RegularMode) && verify_tilt())
+            {
+                double e=norm2(position_error());
+                if (full_pose)
+                    e+=norm2(orientation_error());
+
+                if (!found_best || (e<e_best))
+                {
+                    for (size_t i=0; i<x.length(); i++)
+                        x_best[i]=x[i];
+                    e_best=e;
+                    violation_best=inf_pr;
+                    found_best=true;
+                }
+            }
+
+            // stop if the next iteration, expected to last as much
+            // as the average so far, would overrun the deadline
+            double t=Time::now();
+            if (t+(t-t_start)/(iter+1)>=deadline)
+                return false;
+        }
+
         if (slv.callback!=NULL)
             return slv.callback->exec(iter,Hd,x,T);
         else
@@ -377,6 +827,10 @@ public:
     {
         this->x=verify_solution_against_alpha(n,x,m);
 
+        cost=obj_value;
+        violation=(ip_cq!=NULL)?ip_cq->unscaled_curr_nlp_constraint_violation(Ipopt::NORM_MAX):
+                  std::numeric_limits<double>::max();
+
         zL.resize(n);
         zU.resize(n);
         this->lambda.resize(m);
@@ -0,0 +1,455 @@
+/*
+ * Copyright (C) 2015 iCub Facility - Istituto Italiano di Tecnologia
+ * Author: Ugo Pattacini
+ * email:  ugo.pattacini@iit.it
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+*/
+
+
+/****************************************************************/
+namespace differentiation {
+    enum {
+        forward,
+        central,
+        analytic
+    };
+};
+
+
+/****************************************************************/
+template<bool full_pose_, int configuration_, int differentiation_>
+class ArmNLP : public ArmCommonNLP
+{
+protected:
+    // the problem structure is fully determined at compile time:
+    // constraints are stacked as [heave1] [tilt1] [heave2] tilt2
+    // [position], where heaves are there only when prescribed,
+    // torso terms only when the torso moves and the position only
+    // when the orientation is the objective
+    enum
+    {
+        n_vars=12,
+        n_upper_arm=6,
+        moving_torso=(configuration_!=configuration::no_torso_no_heave) &&
+                     (configuration_!=configuration::no_torso_heave),
+        prescribed_heave=(configuration_==configuration::no_heave) ||
+                         (configuration_==configuration::no_torso_no_heave),
+        has_heave1=prescribed_heave && moving_torso,
+        has_tilt1=moving_torso,
+        has_heave2=prescribed_heave,
+        g_heave1=0,
+        g_tilt1=g_heave1+has_heave1,
+        g_heave2=g_tilt1+has_tilt1,
+        g_tilt2=g_heave2+has_heave2,
+        g_position=g_tilt2+1,
+        n_tripod_constraints=g_position,
+        n_constraints=g_position+(full_pose_?1:0),
+        first_col=moving_torso?0:4,
+        first_tripod_col=moving_torso?0:3,
+        nnz_jac=3*n_tripod_constraints+(full_pose_?n_vars-first_col:0),
+        nnz_hess=(n_vars*(n_vars+1))>>1
+    };
+
+    // derivatives with respect to the six elongations (torso first)
+    // of the objective error, the position error and the heave and
+    // tilt of the tripods, shared by eval_grad_f() and eval_jac_g()
+    bool new_tripod_derivatives;
+    fixed::Vec3 de_obj[6],de_pos[6];
+    double dheave[6],dtilt[6];
+
+    /****************************************************************/
+    fixed::Vec3 objective_error(const fixed::Hom4 &T) const
+    {
+        if (full_pose_)
+            return fixed::dcm2rotvec(quantities.Rd*transposed(T.rotation()));
+        else
+            return quantities.xd-T.position();
+    }
+
+    /****************************************************************/
+    void perturb(const Ipopt::Number *x, const int t, const double delta,
+                 const fixed::Hom4 &M1, fixed::Hom4 &T, TripodFrame &din) const
+    {
+        // the chain upstream of the lower_arm moves rigidly and so
+        // does the chain downstream of the torso
+        const TripodParametersExtended &params=(t<3)?torso:lower_arm;
+        const Ipopt::Number *l=(t<3)?x:x+9;
+        double l_dx[3]={l[0],l[1],l[2]};
+        l_dx[t%3]+=delta;
+
+        TripodFrame d;
+        params.kernel.fkin(l_dx,d,&din);
+        if (t<3)
+            T=fixed::Hom4(d.T)*M1;
+        else
+            T=quantities.M*fixed::Hom4(d.T)*quantities.TN;
+    }
+
+    /****************************************************************/
+    void computeTripodDerivatives(const Ipopt::Number *x, const bool new_x)
+    {
+        if (differentiation_==differentiation::analytic)
+            computeDerivatives(x,new_x);
+        else
+            computeQuantities(x,new_x);
+
+        if (!new_tripod_derivatives)
+            return;
+
+        const FixedQuantities &Q=quantities;
+        if (differentiation_==differentiation::analytic)
+        {
+            for (int t=first_tripod_col; t<6; t++)
+            {
+                int col=(t<3)?t:6+t;
+                const TripodJacobian &Jin=(t<3)?Jin1:Jin2;
+                for (int j=0; j<3; j++)
+                {
+                    de_obj[t][j]=-(full_pose_?jw[col][j]:jv[col][j]);
+                    de_pos[t][j]=-jv[col][j];
+                }
+                dheave[t]=Jin.dp[t%3][2];
+                dtilt[t]=Jin.dn[t%3][2];
+            }
+        }
+        else
+        {
+            fixed::Hom4 M1=Q.H*fixed::Hom4(Q.d2.T)*Q.TN;
+            fixed::Vec3 e_obj=objective_error(Q.T);
+            fixed::Vec3 e_pos=position_error();
+
+            for (int t=first_tripod_col; t<6; t++)
+            {
+                const TripodFrame &din=(t<3)?Q.din1:Q.din2;
+                fixed::Hom4 T_fw,T_bw;
+                TripodFrame din_fw,din_bw;
+
+                perturb(x,t,drho,M1,T_fw,din_fw);
+                if (differentiation_==differentiation::central)
+                {
+                    perturb(x,t,-drho,M1,T_bw,din_bw);
+                    double k=1.0/(2.0*drho);
+
+                    de_obj[t]=k*(objective_error(T_fw)-objective_error(T_bw));
+                    if (full_pose_)
+                        de_pos[t]=k*(T_bw.position()-T_fw.position());
+                    dheave[t]=k*(din_fw.p[2]-din_bw.p[2]);
+                    dtilt[t]=k*(din_fw.n[2]-din_bw.n[2]);
+                }
+                else
+                {
+                    double k=1.0/drho;
+
+                    de_obj[t]=k*(objective_error(T_fw)-e_obj);
+                    if (full_pose_)
+                        de_pos[t]=k*((Q.xd-T_fw.position())-e_pos);
+                    dheave[t]=k*(din_fw.p[2]-din.p[2]);
+                    dtilt[t]=k*(din_fw.n[2]-din.n[2]);
+                }
+            }
+        }
+
+        new_tripod_derivatives=false;
+    }
+
+public:
+    /****************************************************************/
+    ArmNLP(ArmSolver &slv_) : ArmCommonNLP(slv_)
+    {
+        new_tripod_derivatives=true;
+        for (int t=0; t<6; t++)
+            dheave[t]=dtilt[t]=0.0;
+    }
+
+    /****************************************************************/
+    string get_mode() const
+    {
+        static const char *pose[]={"xyz_pose","full_pose"};
+        static const char *conf[]={"no_heave","heave","no_torso_no_heave","no_torso_heave"};
+        static const char *diff[]={"forward_diff","central_diff","analytic_diff"};
+
+        return string(pose[full_pose_?1:0])+"+"+conf[configuration_]+"+"+
+               diff[differentiation_];
+    }
+
+    /************************************************************************/
+    void computeQuantities(const Ipopt::Number *x, const bool new_x)
+    {
+        ArmCommonNLP::computeQuantities(x,new_x);
+        if (new_x)
+            new_tripod_derivatives=true;
+    }
+
+    /****************************************************************/
+    bool get_nlp_info(Ipopt::Index &n, Ipopt::Index &m, Ipopt::Index &nnz_jac_g,
+                      Ipopt::Index &nnz_h_lag, IndexStyleEnum &index_style)
+    {
+        n=n_vars;
+        m=n_constraints;
+        nnz_jac_g=nnz_jac;
+        nnz_h_lag=use_hessian?nnz_hess:0;
+        index_style=TNLP::C_STYLE;
+
+        return true;
+    }
+
+    /****************************************************************/
+    bool get_bounds_info(Ipopt::Index n, Ipopt::Number *x_l, Ipopt::Number *x_u,
+                         Ipopt::Index m, Ipopt::Number *g_l, Ipopt::Number *g_u)
+    {
+        // torso and torso yaw are held at x0 when not optimized
+        iKinChain *chain=upper_arm.asChain();
+        for (int i=0; i<3; i++)
+        {
+            x_l[i]=moving_torso?torso.l_min:x0[i];
+            x_u[i]=moving_torso?torso.l_max:x0[i];
+            x_l[9+i]=lower_arm.l_min;
+            x_u[9+i]=lower_arm.l_max;
+        }
+
+        for (int i=0; i<n_upper_arm; i++)
+        {
+            bool fixed_joint=!moving_torso && (i==0);
+            x_l[3+i]=fixed_joint?x0[3+i]:(*chain)[i].getMin();
+            x_u[3+i]=fixed_joint?x0[3+i]:(*chain)[i].getMax();
+        }
+
+        latch_idx.clear();
+        latch_gl.clear();
+        latch_gu.clear();
+
+        if (has_heave1)
+            g_l[g_heave1]=g_u[g_heave1]=0.0;
+
+        if (has_tilt1)
+        {
+            g_l[g_tilt1]=torso.cos_alpha_max; g_u[g_tilt1]=1.0;
+            latch_idx.push_back(g_tilt1);
+            latch_gl.push_back(g_l[g_tilt1]);
+            latch_gu.push_back(g_u[g_tilt1]);
+        }
+
+        if (has_heave2)
+            g_l[g_heave2]=g_u[g_heave2]=0.0;
+
+        g_l[g_tilt2]=lower_arm.cos_alpha_max; g_u[g_tilt2]=1.0;
+        latch_idx.push_back(g_tilt2);
+        latch_gl.push_back(g_l[g_tilt2]);
+        latch_gu.push_back(g_u[g_tilt2]);
+
+        if (full_pose_)
+            g_l[g_position]=g_u[g_position]=0.0;
+
+        return true;
+    }
+
+    /****************************************************************/
+    bool eval_f(Ipopt::Index n, const Ipopt::Number *x, bool new_x,
+                Ipopt::Number &obj_value)
+    {
+        computeQuantities(x,new_x);
+
+        Ipopt::Number postural_upper_arm=0.0;
+        Ipopt::Number tmp;
+
+        for (int i=1; i<n_upper_arm; i++)
+        {
+            tmp=x[3+i]-x0[3+i];
+            postural_upper_arm+=tmp*tmp;
+        }
+
+        Ipopt::Number postural_lower_arm=(x[9]-x[10])*(x[9]-x[10])+
+                                         (x[10]-x[11])*(x[10]-x[11]);
+
+        obj_value=norm2(objective_error(quantities.T));
+        if (moving_torso)
+        {
+            Ipopt::Number postural_torso=(x[0]-x[1])*(x[0]-x[1])+
+                                         (x[1]-x[2])*(x[1]-x[2]);
+            obj_value+=wpostural_torso*postural_torso;
+            obj_value+=wpostural_torso_yaw*x[3]*x[3];
+        }
+        obj_value+=wpostural_upper_arm*postural_upper_arm;
+        obj_value+=wpostural_lower_arm*postural_lower_arm;
+
+        return true;
+    }
+
+    /****************************************************************/
+    bool eval_grad_f(Ipopt::Index n, const Ipopt::Number* x, bool new_x,
+                     Ipopt::Number *grad_f)
+    {
+        computeTripodDerivatives(x,new_x);
+
+        fixed::Vec3 e=objective_error(quantities.T);
+        const double (*j)[3]=full_pose_?jw:jv;
+
+        // torso
+        if (moving_torso)
+        {
+            grad_f[0]=2.0*dot(e,de_obj[0]) + 2.0*wpostural_torso*(x[0]-x[1]);
+            grad_f[1]=2.0*dot(e,de_obj[1]) + 2.0*wpostural_torso*(2.0*x[1]-x[0]-x[2]);
+            grad_f[2]=2.0*dot(e,de_obj[2]) + 2.0*wpostural_torso*(x[2]-x[1]);
+            grad_f[3]=-2.0*dot3(e,j[3]) + 2.0*wpostural_torso_yaw*x[3];
+        }
+        else
+            grad_f[0]=grad_f[1]=grad_f[2]=grad_f[3]=0.0;
+
+        // upper_arm
+        for (int i=1; i<n_upper_arm; i++)
+            grad_f[3+i]=-2.0*dot3(e,j[3+i]) + 2.0*wpostural_upper_arm*(x[3+i]-x0[3+i]);
+
+        // lower_arm
+        grad_f[9]=2.0*dot(e,de_obj[3]) + 2.0*wpostural_lower_arm*(x[9]-x[10]);
+        grad_f[10]=2.0*dot(e,de_obj[4]) + 2.0*wpostural_lower_arm*(2.0*x[10]-x[9]-x[11]);
+        grad_f[11]=2.0*dot(e,de_obj[5]) + 2.0*wpostural_lower_arm*(x[11]-x[10]);
+
+        return true;
+    }
+
+    /****************************************************************/
+    bool eval_g(Ipopt::Index n, const Ipopt::Number *x, bool new_x,
+                Ipopt::Index m, Ipopt::Number *g)
+    {
+        computeQuantities(x,new_x);
+
+        const FixedQuantities &Q=quantities;
+        if (has_heave1)
+        {
+            double e1=hd1-Q.din1.p[2];
+            g[g_heave1]=e1*e1;
+        }
+
+        if (has_tilt1)
+            g[g_tilt1]=Q.din1.n[2];
+
+        if (has_heave2)
+        {
+            double e2=hd2-Q.din2.p[2];
+            g[g_heave2]=e2*e2;
+        }
+
+        g[g_tilt2]=Q.din2.n[2];
+
+        if (full_pose_)
+            g[g_position]=norm2(position_error());
+
+        latch_x_verifying_alpha(n,x,g);
+
+        return true;
+    }
+
+    /****************************************************************/
+    bool eval_jac_g(Ipopt::Index n, const Ipopt::Number *x, bool new_x,
+                    Ipopt::Index m, Ipopt::Index nele_jac, Ipopt::Index *iRow,
+                    Ipopt::Index *jCol, Ipopt::Number *values)
+    {
+        Ipopt::Index idx=0;
+        if (values==NULL)
+        {
+            // tripods' constraints depend on their own elongations only
+            for (int c=0; c<n_tripod_constraints; c++)
+            {
+                int offs=(c<g_heave2)?0:9;
+                for (int k=0; k<3; k++)
+                {
+                    iRow[idx]=c; jCol[idx]=offs+k;
+                    idx++;
+                }
+            }
+
+            if (full_pose_)
+            {
+                for (int col=first_col; col<n_vars; col++)
+                {
+                    iRow[idx]=g_position; jCol[idx]=col;
+                    idx++;
+                }
+            }
+        }
+        else
+        {
+            computeTripodDerivatives(x,new_x);
+
+            const FixedQuantities &Q=quantities;
+            for (int c=0; c<n_tripod_constraints; c++)
+            {
+                int t=(c<g_heave2)?0:3;
+                bool heave=(has_heave1 && (c==g_heave1)) ||
+                           (has_heave2 && (c==g_heave2));
+                double e=(t==0)?hd1-Q.din1.p[2]:hd2-Q.din2.p[2];
+                for (int k=0; k<3; k++)
+                    values[idx++]=heave?-2.0*e*dheave[t+k]:dtilt[t+k];
+            }
+
+            if (full_pose_)
+            {
+                fixed::Vec3 e=position_error();
+
+                // torso
+                if (moving_torso)
+                    for (int k=0; k<3; k++)
+                        values[idx++]=2.0*dot(e,de_pos[k]);
+
+                // upper_arm
+                for (int i=moving_torso?0:1; i<n_upper_arm; i++)
+                    values[idx++]=-2.0*dot3(e,jv[3+i]);
+
+                // lower_arm
+                for (int k=0; k<3; k++)
+                    values[idx++]=2.0*dot(e,de_pos[3+k]);
+            }
+        }
+
+        return true;
+    }
+
+    /****************************************************************/
+    bool eval_h(Ipopt::Index n, const Ipopt::Number *x, bool new_x,
+                Ipopt::Number obj_factor, Ipopt::Index m, const Ipopt::Number *lambda,
+                bool new_lambda, Ipopt::Index nele_hess, Ipopt::Index *iRow,
+                Ipopt::Index *jCol, Ipopt::Number *values)
+    {
+        if (values==NULL)
+            hessian_structure(n,iRow,jCol);
+        else
+        {
+            computeDerivatives(x,new_x);
+
+            // Gauss-Newton approximation of the Lagrangian
+            hessian_postural(n,obj_factor,moving_torso,values);
+            hessian_add(full_pose_?jw:jv,2.0*obj_factor,values);
+            if (has_heave1)
+                hessian_add_heave(0,Jin1,2.0*lambda[g_heave1],values);
+            if (has_heave2)
+                hessian_add_heave(9,Jin2,2.0*lambda[g_heave2],values);
+            if (full_pose_)
+                hessian_add(jv,2.0*lambda[g_position],values);
+        }
+
+        return true;
+    }
+};
+
+
+/****************************************************************/
+template<bool full_pose_, int configuration_>
+ArmCommonNLP *createArmNLP(ArmSolver &slv, const SolverParameters &params)
+{
+    if (params.use_analytic_derivatives)
+        return new ArmNLP<full_pose_,configuration_,differentiation::analytic>(slv);
+    else if (params.use_central_difference)
+        return new ArmNLP<full_pose_,configuration_,differentiation::central>(slv);
+    else
+        return new ArmNLP<full_pose_,configuration_,differentiation::forward>(slv);
+}
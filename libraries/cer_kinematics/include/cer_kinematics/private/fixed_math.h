@@ -0,0 +1,315 @@
+/*
+ * Copyright (C) 2015 iCub Facility - Istituto Italiano di Tecnologia
+ * Author: Ugo Pattacini
+ * email:  ugo.pattacini@iit.it
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+*/
+
+#ifndef __CER_KINEMATICS_FIXED_MATH_H__
+#define __CER_KINEMATICS_FIXED_MATH_H__
+
+#include <cmath>
+
+#include <yarp/sig/Matrix.h>
+
+namespace cer {
+namespace kinematics {
+namespace fixed {
+
+// Stack-allocated counterparts of the yarp algebra used within
+// the solvers' callbacks. Rows are padded to four doubles to keep
+// the inner loops uniform, with no alignment being enforced as
+// these types are also members of heap-allocated NLPs; the padding
+// elements are kept at zero by all the operations below.
+
+/****************************************************************/
+struct Vec3
+{
+    double v[4];
+
+    /****************************************************************/
+    Vec3()
+    {
+        v[0]=v[1]=v[2]=v[3]=0.0;
+    }
+
+    /****************************************************************/
+    Vec3(const double x, const double y, const double z)
+    {
+        v[0]=x; v[1]=y; v[2]=z; v[3]=0.0;
+    }
+
+    /****************************************************************/
+    double& operator[](const int i)             { return v[i]; }
+    const double& operator[](const int i) const { return v[i]; }
+    const double* data() const                  { return v; }
+};
+
+
+/****************************************************************/
+struct Mat3
+{
+    double m[3][4];
+
+    /****************************************************************/
+    Mat3()
+    {
+        for (int i=0; i<3; i++)
+            for (int j=0; j<4; j++)
+                m[i][j]=(i==j)?1.0:0.0;
+    }
+
+    /****************************************************************/
+    double& operator()(const int r, const int c)             { return m[r][c]; }
+    const double& operator()(const int r, const int c) const { return m[r][c]; }
+
+    /****************************************************************/
+    Vec3 getCol(const int c) const
+    {
+        return Vec3(m[0][c],m[1][c],m[2][c]);
+    }
+};
+
+
+/****************************************************************/
+struct Hom4
+{
+    double m[4][4];
+
+    /****************************************************************/
+    Hom4()
+    {
+        for (int i=0; i<4; i++)
+            for (int j=0; j<4; j++)
+                m[i][j]=(i==j)?1.0:0.0;
+    }
+
+    /****************************************************************/
+    explicit Hom4(const double T[4][4])
+    {
+        for (int i=0; i<4; i++)
+            for (int j=0; j<4; j++)
+                m[i][j]=T[i][j];
+    }
+
+    /****************************************************************/
+    explicit Hom4(const yarp::sig::Matrix &T)
+    {
+        for (int i=0; i<4; i++)
+            for (int j=0; j<4; j++)
+                m[i][j]=T(i,j);
+    }
+
+    /****************************************************************/
+    double& operator()(const int r, const int c)             { return m[r][c]; }
+    const double& operator()(const int r, const int c) const { return m[r][c]; }
+
+    /****************************************************************/
+    Vec3 getCol(const int c) const
+    {
+        return Vec3(m[0][c],m[1][c],m[2][c]);
+    }
+
+    /****************************************************************/
+    Vec3 position() const
+    {
+        return getCol(3);
+    }
+
+    /****************************************************************/
+    Mat3 rotation() const
+    {
+        Mat3 R;
+        for (int i=0; i<3; i++)
+            for (int j=0; j<3; j++)
+                R.m[i][j]=m[i][j];
+        return R;
+    }
+
+    /****************************************************************/
+    void toMatrix(yarp::sig::Matrix &T) const
+    {
+        // resize() reallocates only upon a change in size
+        if ((T.rows()!=4) || (T.cols()!=4))
+            T.resize(4,4);
+
+        for (int i=0; i<4; i++)
+            for (int j=0; j<4; j++)
+                T(i,j)=m[i][j];
+    }
+};
+
+
+/****************************************************************/
+inline Vec3 operator+(const Vec3 &a, const Vec3 &b)
+{
+    Vec3 c;
+    for (int i=0; i<4; i++)
+        c.v[i]=a.v[i]+b.v[i];
+    return c;
+}
+
+
+/****************************************************************/
+inline Vec3 operator-(const Vec3 &a, const Vec3 &b)
+{
+    Vec3 c;
+    for (int i=0; i<4; i++)
+        c.v[i]=a.v[i]-b.v[i];
+    return c;
+}
+
+
+/****************************************************************/
+inline Vec3 operator*(const double k, const Vec3 &a)
+{
+    Vec3 c;
+    for (int i=0; i<4; i++)
+        c.v[i]=k*a.v[i];
+    return c;
+}
+
+
+/****************************************************************/
+inline double dot(const Vec3 &a, const Vec3 &b)
+{
+    double s=0.0;
+    for (int i=0; i<4; i++)
+        s+=a.v[i]*b.v[i];
+    return s;
+}
+
+
+/****************************************************************/
+inline double norm2(const Vec3 &a)
+{
+    return dot(a,a);
+}
+
+
+/****************************************************************/
+inline double norm(const Vec3 &a)
+{
+    return sqrt(dot(a,a));
+}
+
+
+/****************************************************************/
+inline Vec3 cross(const Vec3 &a, const Vec3 &b)
+{
+    return Vec3(a.v[1]*b.v[2]-a.v[2]*b.v[1],
+                a.v[2]*b.v[0]-a.v[0]*b.v[2],
+                a.v[0]*b.v[1]-a.v[1]*b.v[0]);
+}
+
+
+/****************************************************************/
+inline Vec3 operator*(const Mat3 &A, const Vec3 &b)
+{
+    Vec3 c;
+    for (int i=0; i<3; i++)
+        c.v[i]=A.m[i][0]*b.v[0]+A.m[i][1]*b.v[1]+A.m[i][2]*b.v[2];
+    return c;
+}
+
+
+/****************************************************************/
+inline Mat3 operator*(const Mat3 &A, const Mat3 &B)
+{
+    Mat3 C;
+    for (int i=0; i<3; i++)
+        for (int j=0; j<4; j++)
+            C.m[i][j]=A.m[i][0]*B.m[0][j]+A.m[i][1]*B.m[1][j]+A.m[i][2]*B.m[2][j];
+    return C;
+}
+
+
+/****************************************************************/
+inline Mat3 transposed(const Mat3 &A)
+{
+    Mat3 At;
+    for (int i=0; i<3; i++)
+        for (int j=0; j<3; j++)
+            At.m[i][j]=A.m[j][i];
+    return At;
+}
+
+
+/****************************************************************/
+inline Hom4 operator*(const Hom4 &A, const Hom4 &B)
+{
+    // the last row of both operands is [0 0 0 1]
+    Hom4 C;
+    for (int i=0; i<3; i++)
+    {
+        for (int j=0; j<4; j++)
+            C.m[i][j]=A.m[i][0]*B.m[0][j]+A.m[i][1]*B.m[1][j]+
+                      A.m[i][2]*B.m[2][j];
+        C.m[i][3]+=A.m[i][3];
+    }
+    return C;
+}
+
+
+/****************************************************************/
+inline Hom4 dh(const double A, const double D, const double alpha,
+               const double theta)
+{
+    // Denavit-Hartenberg transformation as in iCub::iKin::iKinLink
+    double ct=cos(theta),st=sin(theta);
+    double ca=cos(alpha),sa=sin(alpha);
+
+    Hom4 H;
+    H.m[0][0]=ct; H.m[0][1]=-st*ca; H.m[0][2]=st*sa;  H.m[0][3]=ct*A;
+    H.m[1][0]=st; H.m[1][1]=ct*ca;  H.m[1][2]=-ct*sa; H.m[1][3]=st*A;
+    H.m[2][0]=0.0; H.m[2][1]=sa;    H.m[2][2]=ca;     H.m[2][3]=D;
+    return H;
+}
+
+
+/****************************************************************/
+inline Vec3 dcm2rotvec(const Mat3 &R)
+{
+    // same as iCub::ctrl::dcm2axis() with the axis scaled by the angle
+    Vec3 v(R.m[2][1]-R.m[1][2],R.m[0][2]-R.m[2][0],R.m[1][0]-R.m[0][1]);
+    double r=norm(v);
+    double theta=atan2(0.5*r,0.5*(R.m[0][0]+R.m[1][1]+R.m[2][2]-1.0));
+
+    if (r<1e-9)
+    {
+        // R is symmetric: either theta=0 or theta=pi, where the
+        // axis is the dominant column of (R+I)/2=u*u'
+        if (theta<0.5*M_PI)
+            return Vec3();
+
+        int c=0;
+        for (int i=1; i<3; i++)
+            if (R.m[i][i]>R.m[c][c])
+                c=i;
+
+        Vec3 u=R.getCol(c);
+        u.v[c]+=1.0;
+        return (theta/norm(u))*u;
+    }
+
+    return (theta/r)*v;
+}
+
+}
+
+}
+
+}
+
+#endif
+
@@ -19,15 +19,21 @@
 #define __CER_KINEMATICS_HELPERS_H__
 
 #include <cmath>
+#include <string>
 #include <deque>
 
+#include <yarp/os/Mutex.h>
+#include <yarp/os/LockGuard.h>
 #include <yarp/sig/Vector.h>
 #include <yarp/sig/Matrix.h>
 #include <yarp/math/Math.h>
 
 #include <iCub/ctrl/math.h>
 
+#include <IpIpoptApplication.hpp>
+
 #include <cer_kinematics/utils.h>
+#include <cer_kinematics/tripod_kernel.h>
 
 namespace cer {
 namespace kinematics {
@@ -42,9 +48,12 @@ struct TripodParametersExtended : public TripodParameters
     yarp::sig::Matrix R0;
     yarp::sig::Vector p0;
 
+    TripodKernel kernel;
+
     /****************************************************************/
     TripodParametersExtended(const TripodParameters &parameters) :
-                             TripodParameters(parameters)
+                             TripodParameters(parameters),
+                             kernel(parameters)
     {
         cos_alpha_max=cos(iCub::ctrl::CTRL_DEG2RAD*alpha_max);
 
@@ -76,6 +85,116 @@ struct TripodState
 
     /****************************************************************/
     TripodState():n(3,0.0),u(4,0.0),p(3,0.0),T(yarp::math::eye(4,4)) { }
+
+    /****************************************************************/
+    TripodState& operator=(const TripodFrame &d)
+    {
+        for (int i=0; i<3; i++)
+        {
+            n[i]=d.n[i];
+            u[i]=d.u[i];
+            p[i]=d.p[i];
+        }
+        u[3]=d.u[3];
+
+        for (int i=0; i<4; i++)
+            for (int j=0; j<4; j++)
+                T(i,j)=d.T[i][j];
+
+        return *this;
+    }
+};
+
+
+/****************************************************************/
+class LinearSolverLock
+{
+    static yarp::os::Mutex mutex;
+    bool locked;
+
+    LinearSolverLock();                                     // not implemented
+    LinearSolverLock(const LinearSolverLock&);              // not implemented
+    LinearSolverLock& operator=(const LinearSolverLock&);   // not implemented
+
+public:
+    /****************************************************************/
+    static bool serializes(const std::string &linear_solver)
+    {
+        // solvers run concurrently as long as the linear solver
+        // is reentrant, whereas MUMPS relies on global data
+        return (linear_solver=="mumps");
+    }
+
+    /****************************************************************/
+    LinearSolverLock(Ipopt::IpoptApplication &app) : locked(false)
+    {
+        std::string linear_solver;
+        app.Options()->GetStringValue("linear_solver",linear_solver,"");
+        if (serializes(linear_solver))
+        {
+            mutex.lock();
+            locked=true;
+        }
+    }
+
+    /****************************************************************/
+    ~LinearSolverLock()
+    {
+        if (locked)
+            mutex.unlock();
+    }
+};
+
+
+/****************************************************************/
+class BatchDispatcher
+{
+    yarp::os::Mutex mutex;
+    size_t next;
+    size_t size;
+
+public:
+    /****************************************************************/
+    BatchDispatcher(const size_t size_) : next(0), size(size_) { }
+
+    /****************************************************************/
+    bool pop(size_t &i)
+    {
+        // workers pick up targets one at a time, so that the
+        // load stays balanced regardless of the solving times
+        yarp::os::LockGuard lg(mutex);
+        if (next>=size)
+            return false;
+
+        i=next++;
+        return true;
+    }
+};
+
+
+/****************************************************************/
+class CancellationToken
+{
+    yarp::os::Mutex mutex;
+    bool cancelled;
+
+public:
+    /****************************************************************/
+    CancellationToken() : cancelled(false) { }
+
+    /****************************************************************/
+    void cancel()
+    {
+        yarp::os::LockGuard lg(mutex);
+        cancelled=true;
+    }
+
+    /****************************************************************/
+    bool isCancelled()
+    {
+        yarp::os::LockGuard lg(mutex);
+        return cancelled;
+    }
 };
 
 }
@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2015 iCub Facility - Istituto Italiano di Tecnologia
+ * Author: Ugo Pattacini
+ * email:  ugo.pattacini@iit.it
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+*/
+
+#ifndef __CER_KINEMATICS_REACHABILITY_H__
+#define __CER_KINEMATICS_REACHABILITY_H__
+
+#include <string>
+#include <vector>
+
+#include <yarp/sig/Vector.h>
+#include <yarp/sig/Matrix.h>
+
+#include <cer_kinematics/utils.h>
+
+namespace cer {
+namespace kinematics {
+
+/**
+ * Class to handle the voxelized map of the arm workspace built
+ * for a given torso and lower_arm heave and a given class of
+ * end-effector orientations, which tells in constant time
+ * whether a target position can be reached.
+ *
+ * @author Ugo Pattacini
+ */
+class ReachabilityMap
+{
+protected:
+    std::string arm_type;
+    std::string orientation_class;
+    double torso_heave;
+    double lower_arm_heave;
+    bool full_pose;
+    int configuration;
+    yarp::sig::Vector ud;
+    double ang_tol;
+
+    double origin[3];
+    double step;
+    int size[3];
+
+    std::vector<unsigned char> voxels;
+    std::vector<int> nearest;
+
+    int getIndex(const yarp::sig::Vector &x, const bool clamp) const;
+    void computeNearest();
+
+public:
+    /**
+     * Constructor.
+     */
+    ReachabilityMap();
+
+    /**
+     * Define the map, whose voxels are all marked as unreachable.
+     *
+     * @param arm_type          the arm type ("left"|"right").
+     * @param orientation_class the name of the orientation class.
+     * @param torso_heave       the torso heave the map is built for
+     *                          ([m]).
+     * @param lower_arm_heave   the lower_arm heave the map is built
+     *                          for ([m]).
+     * @param full_pose         true if the map accounts for the
+     *                          end-effector orientation.
+     * @param configuration     the solver configuration the map is
+     *                          built for, which must optimize the
+     *                          torso, as the workspace would
+     *                          otherwise depend on the torso pinned
+     *                          by the caller.
+     * @param ud                the reference orientation of the
+     *                          class given as (axis,angle) in [rad].
+     * @param ang_tol           the maximum angle ([deg]) between a
+     *                          target orientation and ud for the
+     *                          target to belong to the class; a voxel
+     *                          is to be marked as reachable if any
+     *                          orientation within ang_tol is.
+     * @param x_min             the lower corner of the workspace
+     *                          box ([m]).
+     * @param x_max             the upper corner of the workspace
+     *                          box ([m]).
+     * @param step              the voxel side ([m]).
+     * @return true/false on success/failure.
+     */
+    bool configure(const std::string &arm_type,
+                   const std::string &orientation_class,
+                   const double torso_heave, const double lower_arm_heave,
+                   const bool full_pose, const int configuration,
+                   const yarp::sig::Vector &ud,
+                   const double ang_tol, const yarp::sig::Vector &x_min,
+                   const yarp::sig::Vector &x_max, const double step);
+
+    /**
+     * Retrieve the number of voxels.
+     *
+     * @return the number of voxels.
+     */
+    int getNumVoxels() const
+    {
+        return (int)voxels.size();
+    }
+
+    /**
+     * Retrieve the center of a voxel.
+     *
+     * @param i      the voxel index in [0...getNumVoxels()-1].
+     * @return the 3D center of the voxel ([m]).
+     */
+    yarp::sig::Vector getVoxelCenter(const int i) const;
+
+    /**
+     * Mark a voxel.
+     *
+     * @param i                the voxel index.
+     * @param manipulability   the normalized manipulability in
+     *                         [0,1], where 0 marks the voxel as
+     *                         unreachable.
+     */
+    void setVoxel(const int i, const double manipulability);
+
+    /**
+     * Finalize the map once all the voxels are marked, so that
+     * the nearest reachable voxel can be looked up in constant
+     * time.
+     */
+    void finalize();
+
+    /**
+     * Save the map to a binary file.
+     *
+     * @param file   the file name.
+     * @return true/false on success/failure.
+     */
+    bool save(const std::string &file) const;
+
+    /**
+     * Load the map from a binary file.
+     *
+     * @param file   the file name.
+     * @return true/false on success/failure.
+     */
+    bool load(const std::string &file);
+
+    /**
+     * Tell whether the map applies to the given problem.
+     *
+     * @param arm_type  the arm type ("left"|"right").
+     * @param params    the solver parameters.
+     * @param Hd        the desired 4-by-4 homogeneous matrix
+     *                  representing the end-effector frame ([m]).
+     * @return true iff the map has been built for the same arm,
+     *         heaves, mode and configuration and the target
+     *         orientation belongs to the class; maps never apply to
+     *         configurations with no torso.
+     */
+    bool applies(const std::string &arm_type, const SolverParameters &params,
+                 const yarp::sig::Matrix &Hd) const;
+
+    /**
+     * Retrieve the normalized manipulability of a position.
+     *
+     * @param x      the 3D position ([m]).
+     * @return the manipulability in [0,1], where 0 stands for
+     *         unreachable.
+     */
+    double getManipulability(const yarp::sig::Vector &x) const;
+
+    /**
+     * Tell whether a position lies farther than one voxel away
+     * from the reachable workspace.
+     *
+     * @param x      the 3D position ([m]).
+     * @return true iff the position is clearly unreachable.
+     */
+    bool isClearlyUnreachable(const yarp::sig::Vector &x) const;
+
+    /**
+     * Retrieve the center of the reachable voxel nearest to a
+     * position.
+     *
+     * @param x          the 3D position ([m]).
+     * @param x_nearest  the center of the nearest reachable voxel
+     *                   ([m]).
+     * @return true/false on success/failure, which occurs if no
+     *         voxel is reachable.
+     */
+    bool getNearestReachable(const yarp::sig::Vector &x,
+                             yarp::sig::Vector &x_nearest) const;
+};
+
+}
+
+}
+
+#endif
+
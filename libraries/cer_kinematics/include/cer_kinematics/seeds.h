@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2015 iCub Facility - Istituto Italiano di Tecnologia
+ * Author: Ugo Pattacini
+ * email:  ugo.pattacini@iit.it
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+*/
+
+#ifndef __CER_KINEMATICS_SEEDS_H__
+#define __CER_KINEMATICS_SEEDS_H__
+
+#include <string>
+#include <vector>
+
+#include <yarp/os/Mutex.h>
+#include <yarp/sig/Vector.h>
+#include <yarp/sig/Matrix.h>
+
+namespace cer {
+namespace kinematics {
+
+/**
+ * Class to handle a library of solved targets indexed by a k-d
+ * tree over (end-effector pose, torso heave), which provides the
+ * solvers with initial guesses close to new targets.
+ *
+ * The pose is represented by the position along with the x and
+ * z axes of the end-effector frame, the latter being scaled by a
+ * weight in [m] to make them commensurate with the position.
+ *
+ * @author Ugo Pattacini
+ */
+class SeedLibrary
+{
+protected:
+    mutable yarp::os::Mutex mutex;
+    double w_ang;
+
+    std::vector<double> keys;
+    std::vector<yarp::sig::Vector> seeds;
+    std::vector<int> tree;
+
+    void computeKey(const yarp::sig::Matrix &H, const double torso_heave,
+                    double *key) const;
+    double squaredDistance(const double *key1, const double *key2) const;
+    void build(const int lo, const int hi, const int depth);
+    void search(const int lo, const int hi, const int depth,
+                const double *key, int &best, double &best_d2) const;
+    void rebuild();
+
+    // solvers hold a reference to the library
+    SeedLibrary(const SeedLibrary&);
+    SeedLibrary& operator=(const SeedLibrary&);
+
+public:
+    /**
+     * Constructor.
+     *
+     * @param w_ang  the weight ([m]) of the end-effector axes
+     *               within the keys.
+     */
+    SeedLibrary(const double w_ang=0.1);
+
+    /**
+     * Add a solved target.
+     *
+     * @param Hd          the 4-by-4 homogeneous matrix of the
+     *                    target ([m]).
+     * @param torso_heave the torso heave the target was solved
+     *                    with ([m]).
+     * @param q           the solution ([m]-[deg]-[m]).
+     * @note the k-d tree is rebuilt as soon as the entries not
+     *       yet indexed, which are scanned linearly, grow too
+     *       many.
+     */
+    void add(const yarp::sig::Matrix &Hd, const double torso_heave,
+             const yarp::sig::Vector &q);
+
+    /**
+     * Retrieve the solution of the closest solved target.
+     *
+     * @param Hd          the 4-by-4 homogeneous matrix of the new
+     *                    target ([m]).
+     * @param torso_heave the torso heave of the new target ([m]).
+     * @param q           the solution of the closest target
+     *                    ([m]-[deg]-[m]).
+     * @param distance    the distance between the keys of the two
+     *                    targets.
+     * @return true/false on success/failure, which occurs if the
+     *         library is empty.
+     */
+    bool query(const yarp::sig::Matrix &Hd, const double torso_heave,
+               yarp::sig::Vector &q, double &distance) const;
+
+    /**
+     * Compute the distance between the keys of two poses at the
+     * same torso heave.
+     *
+     * @param H1     the first 4-by-4 homogeneous matrix ([m]).
+     * @param H2     the second 4-by-4 homogeneous matrix ([m]).
+     * @return the distance, commensurate with the one returned by
+     *         query().
+     */
+    double distance(const yarp::sig::Matrix &H1,
+                    const yarp::sig::Matrix &H2) const;
+
+    /**
+     * Retrieve the number of solved targets.
+     *
+     * @return the number of solved targets.
+     */
+    size_t size() const;
+
+    /**
+     * Remove all the solved targets.
+     */
+    void clear();
+
+    /**
+     * Save the library to a binary file.
+     *
+     * @param file   the file name.
+     * @return true/false on success/failure.
+     */
+    bool save(const std::string &file) const;
+
+    /**
+     * Load the library from a binary file, replacing its content.
+     *
+     * @param file   the file name.
+     * @return true/false on success/failure.
+     */
+    bool load(const std::string &file);
+};
+
+}
+
+}
+
+#endif
+
@@ -18,9 +18,13 @@
 #ifndef __CER_KINEMATICS_TRIPOD_H__
 #define __CER_KINEMATICS_TRIPOD_H__
 
+#include <string>
+#include <vector>
+
 #include <yarp/sig/Vector.h>
 
 #include <cer_kinematics/utils.h>
+#include <cer_kinematics/tripod_kernel.h>
 
 namespace cer {
 namespace kinematics {
@@ -35,10 +39,27 @@ class TripodSolver : public Solver
 {
 protected:
     TripodParameters parameters;
+    TripodKernel kernel;
     yarp::sig::Vector lll0;
+    bool use_ipopt;
+
+    std::vector<double> lut;
+    double lut_origin[3];
+    double lut_step[3];
+    int lut_size[3];
 
     friend class TripodNLP;
 
+    void getDesiredNormal(const yarp::sig::Matrix &Rd, double *nd) const;
+    void getDesiredNormal(const double *zd, double *nd) const;
+    bool solveNewton(const double zd, const yarp::sig::Vector &ud,
+                     yarp::sig::Vector &lll) const;
+    bool loadLUT(const std::string &cache, const std::vector<double> &header,
+                 std::vector<double> &table) const;
+    bool saveLUT(const std::string &cache, const std::vector<double> &header,
+                 const std::vector<double> &table) const;
+    bool lookupLUT(const yarp::sig::Vector &hpr, yarp::sig::Vector &lll);
+
 public:
     /**
      * Constructor.
@@ -58,6 +79,8 @@ public:
     virtual void setParameters(const TripodParameters &params)
     {
         parameters=params;
+        kernel=TripodKernel(parameters);
+        disableLUT();
     }
 
     /**
@@ -88,6 +111,70 @@ public:
         return lll0;
     }
 
+    /**
+     * Select the numerical method of the Inverse Kinematics Law.
+     * 
+     * @param use_ipopt if false (default), the elongations are 
+     *                  computed in closed form whenever they fall
+     *                  within the bounds, or by a bounded Newton
+     *                  iteration otherwise, with Ipopt as fallback;
+     *                  if true, Ipopt is always employed.
+     */
+    virtual void useIpopt(const bool use_ipopt)
+    {
+        this->use_ipopt=use_ipopt;
+    }
+
+    /**
+     * Tell whether Ipopt is always employed by the Inverse 
+     * Kinematics Law. 
+     * 
+     * @return true iff Ipopt is always employed.
+     */
+    virtual bool isUsingIpopt() const
+    {
+        return use_ipopt;
+    }
+
+    /**
+     * Enable the lookup table for the Inverse Kinematics Law with 
+     * heave-pitch-roll, which is then answered in constant time by
+     * trilinear interpolation over a grid spanning [l_min,l_max] 
+     * and [-alpha_max,alpha_max], followed by one Newton 
+     * refinement. Queries whose refined elongations miss the heave
+     * or exceed the bending limit go through the regular solver. 
+     * 
+     * @param step_heave the grid step along the heave ([m]).
+     * @param step_angle the grid step along pitch and roll 
+     *                   ([deg]).
+     * @param cache      if not empty, the binary file where the 
+     *                   table is loaded from, provided that it was
+     *                   built for the same parameters and steps; 
+     *                   otherwise, the table is built and stored 
+     *                   therein. 
+     * @return true/false on success/failure. 
+     *  
+     * @note The table is dropped upon setParameters().
+     */
+    virtual bool enableLUT(const double step_heave=0.005,
+                           const double step_angle=1.0,
+                           const std::string &cache="");
+
+    /**
+     * Disable the lookup table.
+     */
+    virtual void disableLUT();
+
+    /**
+     * Tell whether the lookup table is in use.
+     * 
+     * @return true iff the lookup table is in use.
+     */
+    virtual bool isLUTEnabled() const
+    {
+        return !lut.empty();
+    }
+
     /**
      * Forward Kinematics Law.
      * 
@@ -133,6 +220,11 @@ public:
      *               vector (axis,angle) expressed in [rad].
      * @param lll    the solved three elongations ([m]).
      * @return true/false on success/failure.
+     *  
+     * @note The rotation about the normal to the platform cannot 
+     *       be attained by the mechanism and is thus disregarded by
+     *       the closed-form/Newton solution, whereas the normal is
+     *       projected within the cone of the permitted bending.
      */
     virtual bool ikin(const double zd, const yarp::sig::Vector &ud,
                       yarp::sig::Vector &lll, int *exit_code=NULL);
@@ -144,6 +236,9 @@ public:
      *               ([deg]) to solve for.
      * @param lll    the solved three elongations ([m]).
      * @return true/false on success/failure.
+     *  
+     * @note The lookup table is used if enabled and hpr falls 
+     *       within its grid.
      */
     virtual bool ikin(const yarp::sig::Vector &hpr,
                       yarp::sig::Vector &lll,
@@ -0,0 +1,340 @@
+/*
+ * Copyright (C) 2015 iCub Facility - Istituto Italiano di Tecnologia
+ * Author: Ugo Pattacini
+ * email:  ugo.pattacini@iit.it
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+*/
+
+#ifndef __CER_KINEMATICS_TRIPOD_KERNEL_H__
+#define __CER_KINEMATICS_TRIPOD_KERNEL_H__
+
+#include <cmath>
+
+#include <cer_kinematics/utils.h>
+
+namespace cer {
+namespace kinematics {
+
+/**
+ * Structure holding the state of the tripod platform on
+ * fixed-size storage.
+ *
+ * @author Ugo Pattacini
+ */
+struct TripodFrame
+{
+    /**
+     * the normal to the platform.
+     */
+    double n[3];
+
+    /**
+     * the orientation of the platform given as (axis,angle) in
+     * [rad].
+     */
+    double u[4];
+
+    /**
+     * the 3d position of the platform center ([m]).
+     */
+    double p[3];
+
+    /**
+     * the 4-by-4 homogeneous matrix of the platform ([m]).
+     */
+    double T[4][4];
+};
+
+
+/**
+ * Structure holding the derivatives of the tripod platform
+ * state with respect to the three elongations.
+ *
+ * @author Ugo Pattacini
+ */
+struct TripodJacobian
+{
+    /**
+     * dn[i] is the derivative of the normal with respect to the
+     * i-th elongation.
+     */
+    double dn[3][3];
+
+    /**
+     * dp[i] is the derivative of the platform center with respect
+     * to the i-th elongation.
+     */
+    double dp[3][3];
+
+    /**
+     * w[i] is the angular velocity of the platform induced by a
+     * unitary rate of the i-th elongation.
+     */
+    double w[3][3];
+};
+
+
+/**
+ * Closed-form forward kinematics of the tripod mechanism
+ * operating on the stack only, thus suitable for high-rate
+ * loops.
+ *
+ * @author Ugo Pattacini
+ */
+class TripodKernel
+{
+protected:
+    double r;
+    double sx[3],sy[3];
+    double T0[4][4];
+
+    /****************************************************************/
+    void configure(const TripodParameters &params)
+    {
+        r=params.r;
+
+        double theta=0.0;
+        for (int i=0; i<3; i++)
+        {
+            sx[i]=r*cos(theta);
+            sy[i]=r*sin(theta);
+            theta+=2.0*M_PI/3.0;
+        }
+
+        for (int i=0; i<4; i++)
+            for (int j=0; j<4; j++)
+                T0[i][j]=params.T0(i,j);
+    }
+
+public:
+    /**
+     * Constructor.
+     *
+     * @param params tripod parameters.
+     */
+    TripodKernel(const TripodParameters &params=TripodParameters())
+    {
+        configure(params);
+    }
+
+    /**
+     * Forward Kinematics Law.
+     *
+     * @param lll       pointer to the three elongations ([m]).
+     * @param d         the platform state expressed in the root
+     *                  frame.
+     * @param internal  if not NULL, the platform state expressed
+     *                  in the tripod frame.
+     */
+    void fkin(const double *lll, TripodFrame &d,
+              TripodFrame *internal=NULL) const
+    {
+        const double &l1=lll[0];
+        const double &l2=lll[1];
+        const double &l3=lll[2];
+
+        double q33=sqrt(27.0)*r/sqrt(12.0*(l3*l3-(l1+l2)*l3+l2*l2-l1*l2+l1*l1)+27.0*r*r);
+
+        TripodFrame din;
+        for (int i=0; i<4; i++)
+            for (int j=0; j<4; j++)
+                din.T[i][j]=(i==j)?1.0:0.0;
+
+        if (q33>=1.0)
+        {
+            din.n[0]=din.n[1]=0.0; din.n[2]=1.0;
+            din.u[0]=din.u[1]=din.u[2]=din.u[3]=0.0;
+            din.p[0]=din.p[1]=0.0;
+            din.p[2]=din.T[2][3]=l1;
+        }
+        else
+        {
+            // n=(v2-v1)x(v3-v1), with vi=si+li*z
+            double a0=sx[1]-sx[0],a1=sy[1]-sy[0],a2=l2-l1;
+            double b0=sx[2]-sx[0],b1=sy[2]-sy[0],b2=l3-l1;
+            din.n[0]=a1*b2-a2*b1;
+            din.n[1]=a2*b0-a0*b2;
+            din.n[2]=a0*b1-a1*b0;
+            double nn=sqrt(din.n[0]*din.n[0]+din.n[1]*din.n[1]+din.n[2]*din.n[2]);
+            din.n[0]/=nn; din.n[1]/=nn; din.n[2]/=nn;
+
+            double sin_theta=sqrt(1.0-q33*q33);
+            din.u[0]=-din.n[1]/sin_theta;
+            din.u[1]=din.n[0]/sin_theta;
+            din.u[2]=0.0;
+            din.u[3]=acos(q33);
+            double tmp=(1.0-q33);
+            double q11=tmp*din.u[0]*din.u[0]+q33;
+            double q22=tmp*din.u[1]*din.u[1]+q33;
+            double q21=tmp*din.u[0]*din.u[1];
+            double q31=-sin_theta*din.u[1];
+            double q32=sin_theta*din.u[0];
+            double m1=r/q33*(-0.5*q11+1.5*q22);
+            din.p[0]=r-m1*q11;
+            din.p[1]=-m1*q21;
+            din.p[2]=l1-m1*q31;
+
+            // transformation matrix
+            din.T[0][0]=q11; din.T[0][1]=q21; din.T[0][2]=-q31; din.T[0][3]=din.p[0];
+            din.T[1][0]=q21; din.T[1][1]=q22; din.T[1][2]=-q32; din.T[1][3]=din.p[1];
+            din.T[2][0]=q31; din.T[2][1]=q32; din.T[2][2]=q33;  din.T[2][3]=din.p[2];
+        }
+
+        if (internal!=NULL)
+            *internal=din;
+
+        // express the state in the root frame
+        for (int i=0; i<3; i++)
+        {
+            d.n[i]=T0[i][0]*din.n[0]+T0[i][1]*din.n[1]+T0[i][2]*din.n[2];
+            d.u[i]=T0[i][0]*din.u[0]+T0[i][1]*din.u[1]+T0[i][2]*din.u[2];
+            d.p[i]=T0[i][0]*din.p[0]+T0[i][1]*din.p[1]+T0[i][2]*din.p[2]+T0[i][3];
+        }
+        d.u[3]=din.u[3];
+
+        for (int i=0; i<4; i++)
+            for (int j=0; j<4; j++)
+                d.T[i][j]=T0[i][0]*din.T[0][j]+T0[i][1]*din.T[1][j]+
+                          T0[i][2]*din.T[2][j]+T0[i][3]*din.T[3][j];
+    }
+
+    /**
+     * Analytic derivatives of the Forward Kinematics Law.
+     *
+     * @param lll       pointer to the three elongations ([m]).
+     * @param J         the derivatives expressed in the root frame.
+     * @param internal  if not NULL, the derivatives expressed in
+     *                  the tripod frame.
+     */
+    void jacobian(const double *lll, TripodJacobian &J,
+                  TripodJacobian *internal=NULL) const
+    {
+        const double &l1=lll[0];
+        const double &l2=lll[1];
+        const double &l3=lll[2];
+
+        // n=(v2-v1)x(v3-v1), with vi=si+li*z
+        double a0=sx[1]-sx[0],a1=sy[1]-sy[0],a2=l2-l1;
+        double b0=sx[2]-sx[0],b1=sy[2]-sy[0],b2=l3-l1;
+        double n[3];
+        n[0]=a1*b2-a2*b1;
+        n[1]=a2*b0-a0*b2;
+        n[2]=a0*b1-a1*b0;
+        double nn=sqrt(n[0]*n[0]+n[1]*n[1]+n[2]*n[2]);
+        n[0]/=nn; n[1]/=nn; n[2]/=nn;
+
+        // the platform rotation only depends on n:
+        // R=[1-nx^2*w -nx*ny*w nx; -nx*ny*w 1-ny^2*w ny; -nx -ny nz]
+        // with w=1/(1+nz)
+        double w=1.0/(1.0+n[2]);
+        double R[3][3];
+        R[0][0]=1.0-n[0]*n[0]*w; R[0][1]=-n[0]*n[1]*w;   R[0][2]=n[0];
+        R[1][0]=R[0][1];         R[1][1]=1.0-n[1]*n[1]*w; R[1][2]=n[1];
+        R[2][0]=-n[0];           R[2][1]=-n[1];           R[2][2]=n[2];
+        double c=-0.5*R[0][0]+1.5*R[1][1];
+        double m1=r/n[2]*c;
+
+        const double da2[3]={-1.0,1.0,0.0};
+        const double db2[3]={-1.0,0.0,1.0};
+
+        TripodJacobian Jin;
+        for (int k=0; k<3; k++)
+        {
+            // derivative of the unnormalized normal
+            double dnr[3];
+            dnr[0]=a1*db2[k]-b1*da2[k];
+            dnr[1]=b0*da2[k]-a0*db2[k];
+            dnr[2]=0.0;
+
+            double ndnr=n[0]*dnr[0]+n[1]*dnr[1]+n[2]*dnr[2];
+            double *dn=Jin.dn[k];
+            for (int i=0; i<3; i++)
+                dn[i]=(dnr[i]-n[i]*ndnr)/nn;
+
+            double dw=-w*w*dn[2];
+            double dR[3][3];
+            dR[0][0]=-(2.0*n[0]*dn[0]*w+n[0]*n[0]*dw);
+            dR[0][1]=-((dn[0]*n[1]+n[0]*dn[1])*w+n[0]*n[1]*dw);
+            dR[0][2]=dn[0];
+            dR[1][0]=dR[0][1];
+            dR[1][1]=-(2.0*n[1]*dn[1]*w+n[1]*n[1]*dw);
+            dR[1][2]=dn[1];
+            dR[2][0]=-dn[0];
+            dR[2][1]=-dn[1];
+            dR[2][2]=dn[2];
+
+            // w=vee(dR*R^T)
+            double *om=Jin.w[k];
+            om[0]=dR[2][0]*R[1][0]+dR[2][1]*R[1][1]+dR[2][2]*R[1][2];
+            om[1]=dR[0][0]*R[2][0]+dR[0][1]*R[2][1]+dR[0][2]*R[2][2];
+            om[2]=dR[1][0]*R[0][0]+dR[1][1]*R[0][1]+dR[1][2]*R[0][2];
+
+            double dm1=r*((-0.5*dR[0][0]+1.5*dR[1][1])/n[2]-c*dn[2]/(n[2]*n[2]));
+            double *dp=Jin.dp[k];
+            dp[0]=-(dm1*R[0][0]+m1*dR[0][0]);
+            dp[1]=-(dm1*R[1][0]+m1*dR[1][0]);
+            dp[2]=((k==0)?1.0:0.0)-(dm1*R[2][0]+m1*dR[2][0]);
+        }
+
+        if (internal!=NULL)
+            *internal=Jin;
+
+        // express the derivatives in the root frame
+        for (int k=0; k<3; k++)
+        {
+            for (int i=0; i<3; i++)
+            {
+                J.dn[k][i]=T0[i][0]*Jin.dn[k][0]+T0[i][1]*Jin.dn[k][1]+T0[i][2]*Jin.dn[k][2];
+                J.dp[k][i]=T0[i][0]*Jin.dp[k][0]+T0[i][1]*Jin.dp[k][1]+T0[i][2]*Jin.dp[k][2];
+                J.w[k][i]=T0[i][0]*Jin.w[k][0]+T0[i][1]*Jin.w[k][1]+T0[i][2]*Jin.w[k][2];
+            }
+        }
+    }
+
+    /**
+     * Geometric Jacobian of a point that moves rigidly with the 
+     * platform. 
+     *
+     * @param d   the platform state as returned by fkin().
+     * @param J   the derivatives as returned by jacobian(), 
+     *            expressed in the same frame as d.
+     * @param p   the 3d position of the point ([m]), expressed in
+     *            the same frame as d.
+     * @param jw  jw[k] is the angular velocity induced by a unitary
+     *            rate of the k-th elongation.
+     * @param jv  jv[k] is the linear velocity of the point induced
+     *            by a unitary rate of the k-th elongation.
+     */
+    static void jacobian(const TripodFrame &d, const TripodJacobian &J,
+                         const double *p, double jw[3][3], double jv[3][3])
+    {
+        double r[3]={p[0]-d.p[0],p[1]-d.p[1],p[2]-d.p[2]};
+        for (int k=0; k<3; k++)
+        {
+            // v=dp+w x r, with r the lever arm from the center
+            const double *w=J.w[k];
+            const double *v=J.dp[k];
+            jw[k][0]=w[0]; jw[k][1]=w[1]; jw[k][2]=w[2];
+            jv[k][0]=v[0]+w[1]*r[2]-w[2]*r[1];
+            jv[k][1]=v[1]+w[2]*r[0]-w[0]*r[2];
+            jv[k][2]=v[2]+w[0]*r[1]-w[1]*r[0];
+        }
+    }
+};
+
+}
+
+}
+
+#endif
+
@@ -243,6 +243,37 @@ struct SolverParameters
      */
     bool warm_start;
 
+    /**
+     * if true compute the derivatives of the tripods in closed
+     * form, instead of resorting to finite difference
+     * approximations.
+     */
+    bool use_analytic_derivatives;
+
+    /**
+     * if true provide the solver with the Hessian of the
+     * Lagrangian (exact for the head, Gauss-Newton approximation
+     * for the arm) instead of resorting to the limited-memory
+     * quasi-Newton approximation.
+     */
+    bool use_hessian;
+
+    /**
+     * if true enable the tracking mode, meant for targets that
+     * move smoothly: the initial guess is predicted from the
+     * previous solution by means of a first-order update toward
+     * the new target and the multipliers are warm started.
+     */
+    bool tracking;
+
+    /**
+     * the linear solver used by Ipopt (e.g. "mumps", "ma27", 
+     * "ma57"); MUMPS relies on global data, hence solvers resorting 
+     * to it are serialized process-wide, whereas concurrent solvers
+     * run truly in parallel only with a reentrant linear solver.
+     */
+    std::string linear_solver;
+
     /**
      * Constructor. 
      *  
@@ -277,6 +308,16 @@ struct SolverParameters
      *                                      forward difference
      *                                      formula.
      * @param warm_start_                   enable warm start.
+     * @param use_analytic_derivatives_     compute the derivatives
+     *                                      of the tripods in closed
+     *                                      form.
+     * @param use_hessian_                  provide the solver with
+     *                                      the Hessian of the
+     *                                      Lagrangian.
+     * @param tracking_                     enable the tracking
+     *                                      mode.
+     * @param linear_solver_                the linear solver used
+     *                                      by Ipopt.
      */
     SolverParameters(const bool full_pose_=true, const bool configuration_=configuration::no_heave,
                      const double torso_heave_=0.0, const double lower_arm_heave_=0.0,
@@ -288,7 +329,11 @@ struct SolverParameters
                      const int max_iter_=std::numeric_limits<int>::max(),
                      const double max_cpu_time_=1.0,
                      const bool use_central_difference_=false,
-                     const bool warm_start_=false) :
+                     const bool warm_start_=false,
+                     const bool use_analytic_derivatives_=false,
+                     const bool use_hessian_=false,
+                     const bool tracking_=false,
+                     const std::string &linear_solver_="mumps") :
                      full_pose(full_pose_), configuration(configuration_),
                      torso_heave(torso_heave_), lower_arm_heave(lower_arm_heave_),
                      weight_postural_torso(weight_postural_torso_),
@@ -298,17 +343,22 @@ struct SolverParameters
                      tol(tol_), constr_tol(constr_tol_),
                      max_iter(max_iter_), max_cpu_time(max_cpu_time_),
                      use_central_difference(use_central_difference_),
-                     warm_start(warm_start_) { }
+                     warm_start(warm_start_),
+                     use_analytic_derivatives(use_analytic_derivatives_),
+                     use_hessian(use_hessian_),
+                     tracking(tracking_),
+                     linear_solver(linear_solver_) { }
 
     /**
      * Helper to internal state according to a string mode.\n 
      * The helper does also set suitable tolerance values.
      *  
      * @param mode  a string that can be a combination of  
-     *              ["full_pose"|"xyz_pose"]+["heave"|"no_heave"|"no_torso_no_heave"|"no_torso_heave"]+["forward_diff"|"central_diff"].
+     *              ["full_pose"|"xyz_pose"]+["heave"|"no_heave"|"no_torso_no_heave"|"no_torso_heave"]+["forward_diff"|"central_diff"|"analytic_diff"].
      *              Examples: "full_pose+central_diff",
      *              "xyz_pose+no_heave",
-     *              "full_pose+heave+forward_diff".
+     *              "full_pose+heave+forward_diff",
+     *              "full_pose+no_heave+analytic_diff".
      * @note the order might affect the setting of internal state, 
      *       therefore the preferred order is: pose + mode + diff.
      * @return true/false on success/failure. 
@@ -357,7 +407,7 @@ public:
 class Solver
 {
 protected:
-    static yarp::os::Mutex makeThreadSafe;
+    mutable yarp::os::Mutex makeThreadSafe;
     SolverIterateCallback *callback;
     int verbosity;
 
@@ -370,6 +420,31 @@ public:
      */
     Solver(const int verb=0) : callback(NULL), verbosity(verb) { }
 
+    /**
+     * Copy constructor. 
+     *  
+     * @param solver the solver to copy from. 
+     * @note the lock guarding the instance is not shared with the 
+     *       source object.
+     */
+    Solver(const Solver &solver) : callback(solver.callback),
+                                   verbosity(solver.verbosity) { }
+
+    /**
+     * Assignment operator. 
+     *  
+     * @param solver the solver to copy from. 
+     * @return a reference to the current object.
+     * @note the lock guarding the instance is not shared with the 
+     *       source object.
+     */
+    Solver& operator=(const Solver &solver)
+    {
+        callback=solver.callback;
+        verbosity=solver.verbosity;
+        return *this;
+    }
+
     /**
      * Specify new verbosity level.
      * 
@@ -16,6 +16,9 @@
 */
 
 #include <string>
+#include <map>
+#include <vector>
+#include <deque>
 #include <cmath>
 #include <limits>
 #include <algorithm>
@@ -23,16 +26,20 @@
 #include <yarp/os/Log.h>
 #include <yarp/os/Time.h>
 #include <yarp/os/LockGuard.h>
+#include <yarp/os/Thread.h>
 #include <yarp/math/Math.h>
+#include <yarp/math/Rand.h>
 
 #include <iCub/ctrl/math.h>
 #include <iCub/iKin/iKinFwd.h>
 
 #include <IpTNLP.hpp>
 #include <IpIpoptApplication.hpp>
+#include <IpIpoptCalculatedQuantities.hpp>
 
 #include <cer_kinematics/arm.h>
 #include <cer_kinematics/private/helpers.h>
+#include <cer_kinematics/private/fixed_math.h>
 
 // COMMON PART -- begin
 #define DELTA_RHO       1e-6
@@ -49,14 +56,434 @@ using namespace cer::kinematics;
 namespace cer {
     namespace kinematics {
         #include <cer_kinematics/private/arm_common.h>
-        #include <cer_kinematics/private/arm_full_noheave.h>
-        #include <cer_kinematics/private/arm_full_heave.h>
-        #include <cer_kinematics/private/arm_full_notorso_noheave.h>
-        #include <cer_kinematics/private/arm_full_notorso_heave.h>
-        #include <cer_kinematics/private/arm_xyz_noheave.h>
-        #include <cer_kinematics/private/arm_xyz_heave.h>
-        #include <cer_kinematics/private/arm_xyz_notorso_noheave.h>
-        #include <cer_kinematics/private/arm_xyz_notorso_heave.h>
+        #include <cer_kinematics/private/arm_nlp.h>
+
+        /****************************************************************/
+        class ArmProfilingNLP : public Ipopt::TNLP
+        {
+            Ipopt::SmartPtr<Ipopt::TNLP> nlp;
+            ArmSolverStats stats;
+
+        public:
+            /****************************************************************/
+            void set_nlp(Ipopt::SmartPtr<Ipopt::TNLP> nlp)
+            {
+                this->nlp=nlp;
+                stats=ArmSolverStats();
+            }
+
+            /****************************************************************/
+            const ArmSolverStats& get_stats() const
+            {
+                return stats;
+            }
+
+            /****************************************************************/
+            bool get_nlp_info(Ipopt::Index &n, Ipopt::Index &m, Ipopt::Index &nnz_jac_g,
+                              Ipopt::Index &nnz_h_lag, IndexStyleEnum &index_style)
+            {
+                return nlp->get_nlp_info(n,m,nnz_jac_g,nnz_h_lag,index_style);
+            }
+
+            /****************************************************************/
+            bool get_bounds_info(Ipopt::Index n, Ipopt::Number *x_l, Ipopt::Number *x_u,
+                                 Ipopt::Index m, Ipopt::Number *g_l, Ipopt::Number *g_u)
+            {
+                return nlp->get_bounds_info(n,x_l,x_u,m,g_l,g_u);
+            }
+
+            /****************************************************************/
+            bool get_starting_point(Ipopt::Index n, bool init_x, Ipopt::Number *x,
+                                    bool init_z, Ipopt::Number *z_L, Ipopt::Number *z_U,
+                                    Ipopt::Index m, bool init_lambda, Ipopt::Number *lambda)
+            {
+                return nlp->get_starting_point(n,init_x,x,init_z,z_L,z_U,
+                                               m,init_lambda,lambda);
+            }
+
+            /****************************************************************/
+            bool eval_f(Ipopt::Index n, const Ipopt::Number *x, bool new_x,
+                        Ipopt::Number &obj_value)
+            {
+                double t0=Time::now();
+                bool ret=nlp->eval_f(n,x,new_x,obj_value);
+                stats.eval_f_time+=Time::now()-t0;
+                stats.eval_f_calls++;
+                return ret;
+            }
+
+            /****************************************************************/
+            bool eval_grad_f(Ipopt::Index n, const Ipopt::Number* x, bool new_x,
+                             Ipopt::Number *grad_f)
+            {
+                double t0=Time::now();
+                bool ret=nlp->eval_grad_f(n,x,new_x,grad_f);
+                stats.eval_grad_f_time+=Time::now()-t0;
+                stats.eval_grad_f_calls++;
+                return ret;
+            }
+
+            /****************************************************************/
+            bool eval_g(Ipopt::Index n, const Ipopt::Number *x, bool new_x,
+                        Ipopt::Index m, Ipopt::Number *g)
+            {
+                double t0=Time::now();
+                bool ret=nlp->eval_g(n,x,new_x,m,g);
+                stats.eval_g_time+=Time::now()-t0;
+                stats.eval_g_calls++;
+                return ret;
+            }
+
+            /****************************************************************/
+            bool eval_jac_g(Ipopt::Index n, const Ipopt::Number *x, bool new_x,
+                            Ipopt::Index m, Ipopt::Index nele_jac, Ipopt::Index *iRow,
+                            Ipopt::Index *jCol, Ipopt::Number *values)
+            {
+                double t0=Time::now();
+                bool ret=nlp->eval_jac_g(n,x,new_x,m,nele_jac,iRow,jCol,values);
+                stats.eval_jac_g_time+=Time::now()-t0;
+                stats.eval_jac_g_calls++;
+                return ret;
+            }
+
+            /****************************************************************/
+            bool eval_h(Ipopt::Index n, const Ipopt::Number *x, bool new_x,
+                        Ipopt::Number obj_factor, Ipopt::Index m, const Ipopt::Number *lambda,
+                        bool new_lambda, Ipopt::Index nele_hess, Ipopt::Index *iRow,
+                        Ipopt::Index *jCol, Ipopt::Number *values)
+            {
+                double t0=Time::now();
+                bool ret=nlp->eval_h(n,x,new_x,obj_factor,m,lambda,new_lambda,
+                                     nele_hess,iRow,jCol,values);
+                stats.eval_h_time+=Time::now()-t0;
+                stats.eval_h_calls++;
+                return ret;
+            }
+
+            /****************************************************************/
+            bool intermediate_callback(Ipopt::AlgorithmMode mode, Ipopt::Index iter,
+                                       Ipopt::Number obj_value, Ipopt::Number inf_pr,
+                                       Ipopt::Number inf_du, Ipopt::Number mu,
+                                       Ipopt::Number d_norm, Ipopt::Number regularization_size,
+                                       Ipopt::Number alpha_du, Ipopt::Number alpha_pr,
+                                       Ipopt::Index ls_trials, const Ipopt::IpoptData* ip_data,
+                                       Ipopt::IpoptCalculatedQuantities* ip_cq)
+            {
+                return nlp->intermediate_callback(mode,iter,obj_value,inf_pr,inf_du,mu,
+                                                  d_norm,regularization_size,alpha_du,
+                                                  alpha_pr,ls_trials,ip_data,ip_cq);
+            }
+
+            /****************************************************************/
+            void finalize_solution(Ipopt::SolverReturn status, Ipopt::Index n,
+                                   const Ipopt::Number *x, const Ipopt::Number *z_L,
+                                   const Ipopt::Number *z_U, Ipopt::Index m,
+                                   const Ipopt::Number *g, const Ipopt::Number *lambda,
+                                   Ipopt::Number obj_value, const Ipopt::IpoptData *ip_data,
+                                   Ipopt::IpoptCalculatedQuantities *ip_cq)
+            {
+                nlp->finalize_solution(status,n,x,z_L,z_U,m,g,lambda,
+                                       obj_value,ip_data,ip_cq);
+            }
+        };
+
+        /****************************************************************/
+        struct ArmSolverCache
+        {
+            Ipopt::SmartPtr<Ipopt::IpoptApplication> app;
+            map<int,Ipopt::SmartPtr<ArmCommonNLP> > nlps;
+            deque<ArmSolver*> workers;
+            CancellationToken *cancellation;
+
+            // most recent fkin() results, the newest first
+            struct FkinEntry
+            {
+                Vector q;
+                int frame;
+                Matrix H;
+            };
+            deque<FkinEntry> fkins;
+            unsigned int fkin_hits,fkin_misses;
+
+            // statistics of the most recent solutions, the oldest
+            // first, collected by wrapping the problem
+            Ipopt::SmartPtr<ArmProfilingNLP> profiler;
+            deque<ArmSolverStats> stats;
+
+            // options the application is currently configured with
+            SolverParameters slvParameters;
+            int print_level;
+            string warm_start_str;
+
+            /****************************************************************/
+            ArmSolverCache() : cancellation(NULL), fkin_hits(0),
+                               fkin_misses(0), print_level(-1),
+                               warm_start_str("no")
+            {
+                app=new Ipopt::IpoptApplication;
+                profiler=new ArmProfilingNLP;
+                app->Options()->SetIntegerValue("acceptable_iter",0);
+                app->Options()->SetStringValue("mu_strategy","monotone");
+                app->Options()->SetStringValue("nlp_scaling_method","gradient-based");
+                app->Options()->SetNumericValue("nlp_scaling_max_gradient",1.0);
+                app->Options()->SetNumericValue("nlp_scaling_min_value",1e-6);
+                app->Options()->SetStringValue("hessian_approximation","limited-memory");
+                app->Options()->SetStringValue("fixed_variable_treatment","make_parameter");
+                app->Options()->SetNumericValue("warm_start_bound_push",1e-6);
+                app->Options()->SetNumericValue("warm_start_mult_bound_push",1e-6);
+                app->Options()->SetStringValue("warm_start_init_point",warm_start_str.c_str());
+
+                // force the first configuration
+                slvParameters.tol=slvParameters.constr_tol=-1.0;
+                slvParameters.max_iter=-1;
+                slvParameters.max_cpu_time=-1.0;
+                slvParameters.linear_solver="";
+            }
+
+            /****************************************************************/
+            Ipopt::SmartPtr<Ipopt::IpoptApplication> getApplication(const SolverParameters &params,
+                                                                    const int print_level,
+                                                                    const string &warm_start_str)
+            {
+                if (params.tol!=slvParameters.tol)
+                    app->Options()->SetNumericValue("tol",params.tol);
+                if (params.constr_tol!=slvParameters.constr_tol)
+                    app->Options()->SetNumericValue("constr_viol_tol",params.constr_tol);
+                if (params.max_iter!=slvParameters.max_iter)
+                    app->Options()->SetIntegerValue("max_iter",params.max_iter);
+                if (params.max_cpu_time!=slvParameters.max_cpu_time)
+                    app->Options()->SetNumericValue("max_cpu_time",params.max_cpu_time);
+                if (params.use_hessian!=slvParameters.use_hessian)
+                    app->Options()->SetStringValue("hessian_approximation",params.use_hessian?"exact":"limited-memory");
+                if (params.linear_solver!=slvParameters.linear_solver)
+                    app->Options()->SetStringValue("linear_solver",params.linear_solver.c_str());
+                slvParameters=params;
+
+                if (warm_start_str!=this->warm_start_str)
+                {
+                    app->Options()->SetStringValue("warm_start_init_point",warm_start_str.c_str());
+                    app->Options()->SetNumericValue("mu_init",(warm_start_str=="yes")?1e-6:0.1);
+                    this->warm_start_str=warm_start_str;
+                }
+
+                // the console output is set up upon initialization
+                if (print_level!=this->print_level)
+                {
+                    app->Options()->SetStringValue("derivative_test",print_level>=4?"first-order":"none");
+                    app->Options()->SetIntegerValue("print_level",print_level);
+                    app->Initialize();
+                    this->print_level=print_level;
+                }
+
+                return app;
+            }
+
+            /****************************************************************/
+            Ipopt::SmartPtr<ArmCommonNLP> getNLP(ArmSolver &slv, const SolverParameters &params)
+            {
+                int key=(params.full_pose?0x01:0x00)|(params.configuration<<1)|
+                        ((params.use_central_difference?0x01:0x00)<<3)|
+                        ((params.use_analytic_derivatives?0x01:0x00)<<4);
+
+                map<int,Ipopt::SmartPtr<ArmCommonNLP> >::iterator it=nlps.find(key);
+                if (it!=nlps.end())
+                    return it->second;
+
+                // each mode is served by its own specialization
+                Ipopt::SmartPtr<ArmCommonNLP> nlp;
+                if (params.full_pose)
+                {
+                    switch (params.configuration)
+                    {
+                    case configuration::no_torso_no_heave:
+                        nlp=createArmNLP<true,configuration::no_torso_no_heave>(slv,params);
+                        break;
+                    case configuration::no_torso_heave:
+                        nlp=createArmNLP<true,configuration::no_torso_heave>(slv,params);
+                        break;
+                    case configuration::heave:
+                        nlp=createArmNLP<true,configuration::heave>(slv,params);
+                        break;
+                    default:
+                        nlp=createArmNLP<true,configuration::no_heave>(slv,params);
+                    }
+                }
+                else
+                {
+                    switch (params.configuration)
+                    {
+                    case configuration::no_torso_no_heave:
+                        nlp=createArmNLP<false,configuration::no_torso_no_heave>(slv,params);
+                        break;
+                    case configuration::no_torso_heave:
+                        nlp=createArmNLP<false,configuration::no_torso_heave>(slv,params);
+                        break;
+                    case configuration::heave:
+                        nlp=createArmNLP<false,configuration::heave>(slv,params);
+                        break;
+                    default:
+                        nlp=createArmNLP<false,configuration::no_heave>(slv,params);
+                    }
+                }
+
+                nlps[key]=nlp;
+                return nlp;
+            }
+
+            /****************************************************************/
+            Matrix fkin(ArmCommonNLP &nlp, const Vector &q, const int frame,
+                        const int size, const double tol)
+            {
+                // all the negative frames refer to the end-effector
+                int key=std::max(frame,-1);
+                for (size_t i=0; i<fkins.size(); i++)
+                {
+                    const FkinEntry &entry=fkins[i];
+                    if ((entry.frame!=key) || (entry.q.length()!=q.length()))
+                        continue;
+
+                    bool match=true;
+                    for (size_t j=0; (j<q.length()) && match; j++)
+                        match=(fabs(entry.q[j]-q[j])<=tol);
+
+                    if (match)
+                    {
+                        fkin_hits++;
+
+                        // keep the most recent entries in front
+                        if (i>0)
+                        {
+                            FkinEntry hit=entry;
+                            fkins.erase(fkins.begin()+i);
+                            fkins.push_front(hit);
+                        }
+                        return fkins.front().H;
+                    }
+                }
+
+                fkin_misses++;
+                Matrix H=nlp.fkin(q,frame);
+                if (size>0)
+                {
+                    FkinEntry entry;
+                    entry.q=q;
+                    entry.frame=key;
+                    entry.H=H;
+                    fkins.push_front(entry);
+                    while (fkins.size()>(size_t)size)
+                        fkins.pop_back();
+                }
+
+                return H;
+            }
+
+            /****************************************************************/
+            void push_stats(const ArmSolverStats &s, const int size)
+            {
+                stats.push_back(s);
+                while (stats.size()>(size_t)std::max(size,0))
+                    stats.pop_front();
+            }
+
+            /****************************************************************/
+            void clearWorkers()
+            {
+                for (size_t i=0; i<workers.size(); i++)
+                    delete workers[i];
+                workers.clear();
+            }
+
+            /****************************************************************/
+            ~ArmSolverCache()
+            {
+                clearWorkers();
+            }
+        };
+
+        /****************************************************************/
+        class ArmBatchWorker : public Thread
+        {
+            ArmSolver &solver;
+            BatchDispatcher &dispatcher;
+            const deque<Matrix> &Hd;
+            const deque<double> &heave;
+            const deque<Vector> &q0;
+            deque<Vector> &q;
+            deque<int> &exit_codes;
+            deque<double> &timings;
+            bool ret;
+
+            /****************************************************************/
+            void run()
+            {
+                size_t i;
+                while (dispatcher.pop(i))
+                {
+                    if (heave.size()>0)
+                    {
+                        SolverParameters params=solver.getSolverParameters();
+                        params.torso_heave=heave[i];
+                        solver.setSolverParameters(params);
+                    }
+
+                    if (q0.size()>0)
+                        ret&=solver.setInitialGuess(q0[i]);
+
+                    double t0=Time::now();
+                    ret&=solver.ikin(Hd[i],q[i],&exit_codes[i]);
+                    timings[i]=Time::now()-t0;
+                }
+            }
+
+        public:
+            /****************************************************************/
+            ArmBatchWorker(ArmSolver &solver_, BatchDispatcher &dispatcher_,
+                           const deque<Matrix> &Hd_, const deque<double> &heave_,
+                           const deque<Vector> &q0_, deque<Vector> &q_,
+                           deque<int> &exit_codes_, deque<double> &timings_) :
+                           solver(solver_), dispatcher(dispatcher_), Hd(Hd_),
+                           heave(heave_), q0(q0_), q(q_), exit_codes(exit_codes_),
+                           timings(timings_), ret(true) { }
+
+            /****************************************************************/
+            bool succeeded() const
+            {
+                return ret;
+            }
+        };
+
+        /****************************************************************/
+        class ArmMultiStartWorker : public Thread
+        {
+            ArmSolver &solver;
+            CancellationToken &token;
+            const Matrix &Hd;
+            Vector &q;
+            int &exit_code;
+            bool ret;
+
+            /****************************************************************/
+            void run()
+            {
+                // the first start that converges stops the others
+                ret=solver.ikin(Hd,q,&exit_code);
+                if (ret)
+                    token.cancel();
+            }
+
+        public:
+            /****************************************************************/
+            ArmMultiStartWorker(ArmSolver &solver_, CancellationToken &token_,
+                                const Matrix &Hd_, Vector &q_, int &exit_code_) :
+                                solver(solver_), token(token_), Hd(Hd_), q(q_),
+                                exit_code(exit_code_), ret(false) { }
+
+            /****************************************************************/
+            bool succeeded() const
+            {
+                return ret;
+            }
+        };
     }
 }
 
@@ -67,18 +494,293 @@ ArmSolver::ArmSolver(const ArmParameters &armParams,
                      const int verb) :
                      Solver(verb),
                      armParameters(armParams),
-                     slvParameters(slvParams)
+                     slvParameters(slvParams),
+                     fkinCacheSize(8),
+                     fkinCacheTol(0.0),
+                     reachClamp(false),
+                     seedLibrary(NULL),
+                     seedLearn(false),
+                     statsSize(100),
+                     cache(NULL)
 {
     q0.resize(3+armParameters.upper_arm.getDOF()+3,0.0);
     curMode=computeMode();
 }
 
 
+/****************************************************************/
+ArmSolver::ArmSolver(const ArmSolver &solver) :
+                     Solver(solver),
+                     armParameters(solver.armParameters),
+                     slvParameters(solver.slvParameters),
+                     q0(solver.q0), zL(solver.zL), zU(solver.zU),
+                     lambda(solver.lambda), prevQ(solver.prevQ),
+                     curMode(solver.curMode),
+                     fkinCacheSize(solver.fkinCacheSize),
+                     fkinCacheTol(solver.fkinCacheTol),
+                     reachMaps(solver.reachMaps),
+                     reachClamp(solver.reachClamp),
+                     seedLibrary(solver.seedLibrary),
+                     seedLearn(solver.seedLearn),
+                     statsSize(solver.statsSize),
+                     cache(NULL)
+{
+}
+
+
+/****************************************************************/
+ArmSolver& ArmSolver::operator=(const ArmSolver &solver)
+{
+    if (this!=&solver)
+    {
+        LockGuard lg(makeThreadSafe);
+        Solver::operator=(solver);
+        armParameters=solver.armParameters;
+        slvParameters=solver.slvParameters;
+        q0=solver.q0;
+        zL=solver.zL;
+        zU=solver.zU;
+        lambda=solver.lambda;
+        prevQ=solver.prevQ;
+        curMode=solver.curMode;
+        reachMaps=solver.reachMaps;
+        reachClamp=solver.reachClamp;
+        seedLibrary=solver.seedLibrary;
+        seedLearn=solver.seedLearn;
+        statsSize=solver.statsSize;
+        fkinCacheSize=solver.fkinCacheSize;
+        fkinCacheTol=solver.fkinCacheTol;
+
+        // cached problems refer to the former parameters
+        delete cache;
+        cache=NULL;
+    }
+
+    return *this;
+}
+
+
+/****************************************************************/
+void ArmSolver::setArmParameters(const ArmParameters &params)
+{
+    LockGuard lg(makeThreadSafe);
+    armParameters=params;
+    prevQ.resize(0);
+    if (cache!=NULL)
+    {
+        cache->nlps.clear();
+        cache->fkins.clear();
+        cache->clearWorkers();
+    }
+}
+
+
+/****************************************************************/
+void ArmSolver::setFkinCache(const int size, const double tol)
+{
+    LockGuard lg(makeThreadSafe);
+    fkinCacheSize=std::max(size,0);
+    fkinCacheTol=std::max(tol,0.0);
+    if (cache!=NULL)
+        cache->fkins.clear();
+}
+
+
+/****************************************************************/
+void ArmSolver::addReachabilityMap(const ReachabilityMap &map)
+{
+    LockGuard lg(makeThreadSafe);
+    reachMaps.push_back(map);
+}
+
+
+/****************************************************************/
+void ArmSolver::clearReachabilityMaps()
+{
+    LockGuard lg(makeThreadSafe);
+    reachMaps.clear();
+}
+
+
+/****************************************************************/
+void ArmSolver::setReachabilityClamping(const bool clamp)
+{
+    LockGuard lg(makeThreadSafe);
+    reachClamp=clamp;
+}
+
+
+/****************************************************************/
+void ArmSolver::setStatsBufferSize(const int size)
+{
+    LockGuard lg(makeThreadSafe);
+    statsSize=std::max(size,0);
+    if (cache!=NULL)
+        cache->stats.clear();
+}
+
+
+/****************************************************************/
+void ArmSolver::getStats(deque<ArmSolverStats> &stats) const
+{
+    LockGuard lg(makeThreadSafe);
+    if (cache!=NULL)
+        stats=cache->stats;
+    else
+        stats.clear();
+}
+
+
+/****************************************************************/
+bool ArmSolver::getStatsPercentile(const double p, ArmSolverStats &stats) const
+{
+    static int ArmSolverStats::* const ints[]=
+    {
+        &ArmSolverStats::eval_f_calls, &ArmSolverStats::eval_grad_f_calls,
+        &ArmSolverStats::eval_g_calls, &ArmSolverStats::eval_jac_g_calls,
+        &ArmSolverStats::eval_h_calls, &ArmSolverStats::iterations
+    };
+
+    static double ArmSolverStats::* const doubles[]=
+    {
+        &ArmSolverStats::eval_f_time, &ArmSolverStats::eval_grad_f_time,
+        &ArmSolverStats::eval_g_time, &ArmSolverStats::eval_jac_g_time,
+        &ArmSolverStats::eval_h_time, &ArmSolverStats::ipopt_time,
+        &ArmSolverStats::total_time, &ArmSolverStats::constraint_violation
+    };
+
+    LockGuard lg(makeThreadSafe);
+    if ((cache==NULL) || cache->stats.empty())
+        return false;
+
+    // nearest-rank percentile
+    const deque<ArmSolverStats> &buffer=cache->stats;
+    size_t N=buffer.size();
+    size_t k=(size_t)ceil((std::min(std::max(p,0.0),100.0)/100.0)*N);
+    k=(k>0)?k-1:0;
+
+    stats=ArmSolverStats();
+    vector<double> values(N);
+    for (size_t i=0; i<sizeof(ints)/sizeof(ints[0]); i++)
+    {
+        for (size_t j=0; j<N; j++)
+            values[j]=buffer[j].*ints[i];
+        nth_element(values.begin(),values.begin()+k,values.end());
+        stats.*ints[i]=(int)values[k];
+    }
+
+    for (size_t i=0; i<sizeof(doubles)/sizeof(doubles[0]); i++)
+    {
+        for (size_t j=0; j<N; j++)
+            values[j]=buffer[j].*doubles[i];
+        nth_element(values.begin(),values.begin()+k,values.end());
+        stats.*doubles[i]=values[k];
+    }
+
+    return true;
+}
+
+
+/****************************************************************/
+void ArmSolver::printStats() const
+{
+    ArmSolverStats p50,p90,p99;
+    if (!getStatsPercentile(50.0,p50) || !getStatsPercentile(90.0,p90) ||
+        !getStatsPercentile(99.0,p99))
+    {
+        yInfo(" *** Arm Solver: no statistics available");
+        return;
+    }
+
+    deque<ArmSolverStats> buffer;
+    getStats(buffer);
+
+    int converged=0,warm_started=0;
+    for (size_t i=0; i<buffer.size(); i++)
+    {
+        if ((buffer[i].exit_code==Ipopt::Solve_Succeeded) ||
+            (buffer[i].exit_code==Ipopt::Solved_To_Acceptable_Level) ||
+            (buffer[i].exit_code==Ipopt::Feasible_Point_Found))
+            converged++;
+        if (buffer[i].warm_start)
+            warm_started++;
+    }
+
+    double N=(double)buffer.size();
+    yInfo(" *** Arm Solver ******************************");
+    yInfo(" *** Arm Solver:        solutions [#] = %d",(int)buffer.size());
+    yInfo(" *** Arm Solver:        converged [%%] = %g",100.0*converged/N);
+    yInfo(" *** Arm Solver:     warm_started [%%] = %g",100.0*warm_started/N);
+    yInfo(" *** Arm Solver: percentiles               50th / 90th / 99th");
+    yInfo(" *** Arm Solver:       iterations [#] = %d / %d / %d",p50.iterations,p90.iterations,p99.iterations);
+    yInfo(" *** Arm Solver:           eval_f [#] = %d / %d / %d",p50.eval_f_calls,p90.eval_f_calls,p99.eval_f_calls);
+    yInfo(" *** Arm Solver:      eval_grad_f [#] = %d / %d / %d",p50.eval_grad_f_calls,p90.eval_grad_f_calls,p99.eval_grad_f_calls);
+    yInfo(" *** Arm Solver:           eval_g [#] = %d / %d / %d",p50.eval_g_calls,p90.eval_g_calls,p99.eval_g_calls);
+    yInfo(" *** Arm Solver:       eval_jac_g [#] = %d / %d / %d",p50.eval_jac_g_calls,p90.eval_jac_g_calls,p99.eval_jac_g_calls);
+    yInfo(" *** Arm Solver:           eval_h [#] = %d / %d / %d",p50.eval_h_calls,p90.eval_h_calls,p99.eval_h_calls);
+    yInfo(" *** Arm Solver:          eval_f [ms] = %g / %g / %g",1000.0*p50.eval_f_time,1000.0*p90.eval_f_time,1000.0*p99.eval_f_time);
+    yInfo(" *** Arm Solver:     eval_grad_f [ms] = %g / %g / %g",1000.0*p50.eval_grad_f_time,1000.0*p90.eval_grad_f_time,1000.0*p99.eval_grad_f_time);
+    yInfo(" *** Arm Solver:          eval_g [ms] = %g / %g / %g",1000.0*p50.eval_g_time,1000.0*p90.eval_g_time,1000.0*p99.eval_g_time);
+    yInfo(" *** Arm Solver:      eval_jac_g [ms] = %g / %g / %g",1000.0*p50.eval_jac_g_time,1000.0*p90.eval_jac_g_time,1000.0*p99.eval_jac_g_time);
+    yInfo(" *** Arm Solver:          eval_h [ms] = %g / %g / %g",1000.0*p50.eval_h_time,1000.0*p90.eval_h_time,1000.0*p99.eval_h_time);
+    yInfo(" *** Arm Solver:           ipopt [ms] = %g / %g / %g",1000.0*p50.ipopt_time,1000.0*p90.ipopt_time,1000.0*p99.ipopt_time);
+    yInfo(" *** Arm Solver:           total [ms] = %g / %g / %g",1000.0*p50.total_time,1000.0*p90.total_time,1000.0*p99.total_time);
+    yInfo(" *** Arm Solver:        violation [*] = %g / %g / %g",p50.constraint_violation,p90.constraint_violation,p99.constraint_violation);
+    yInfo(" *** Arm Solver ******************************");
+}
+
+
+/****************************************************************/
+void ArmSolver::clearStats()
+{
+    LockGuard lg(makeThreadSafe);
+    if (cache!=NULL)
+        cache->stats.clear();
+}
+
+
+/****************************************************************/
+void ArmSolver::enableSeedLibrary(SeedLibrary &library, const bool learn)
+{
+    LockGuard lg(makeThreadSafe);
+    seedLibrary=&library;
+    seedLearn=learn;
+}
+
+
+/****************************************************************/
+void ArmSolver::disableSeedLibrary()
+{
+    LockGuard lg(makeThreadSafe);
+    seedLibrary=NULL;
+    seedLearn=false;
+}
+
+
+/****************************************************************/
+void ArmSolver::getFkinCacheStats(unsigned int &hits,
+                                  unsigned int &misses) const
+{
+    LockGuard lg(makeThreadSafe);
+    hits=(cache!=NULL)?cache->fkin_hits:0;
+    misses=(cache!=NULL)?cache->fkin_misses:0;
+}
+
+
 /****************************************************************/
 int ArmSolver::computeMode() const
 {
     return ((slvParameters.full_pose?0x01:0x00) | 
-            ((slvParameters.configuration?0x01:0x00)<<1));
+            (slvParameters.configuration<<1));
+}
+
+
+/****************************************************************/
+ArmSolverCache& ArmSolver::getCache()
+{
+    if (cache==NULL)
+        cache=new ArmSolverCache;
+    return *cache;
 }
 
 
@@ -107,136 +809,254 @@ bool ArmSolver::fkin(const Vector &q, Matrix &H, const int frame)
         return false;
     }
 
-    Ipopt::SmartPtr<ArmFullNoHeaveNLP_ForwardDiff> nlp=new ArmFullNoHeaveNLP_ForwardDiff(*this);
-    H=nlp->fkin(q,frame);
+    LockGuard lg(makeThreadSafe);
+    Ipopt::SmartPtr<ArmCommonNLP> nlp=getCache().getNLP(*this,slvParameters);
+    H=getCache().fkin(*nlp,q,frame,fkinCacheSize,fkinCacheTol);
 
     return true;
 }
 
 
 /****************************************************************/
-bool ArmSolver::ikin(const Matrix &Hd, Vector &q, int *exit_code)
+bool ArmSolver::screenTarget(Matrix &Hd) const
 {
-    LockGuard lg(makeThreadSafe);
-    if ((Hd.rows()!=4) || (Hd.cols()!=4))
+    string type=armParameters.upper_arm.getType();
+    for (size_t i=0; i<reachMaps.size(); i++)
+    {
+        const ReachabilityMap &map=reachMaps[i];
+        if (!map.applies(type,slvParameters,Hd))
+            continue;
+
+        Vector x=Hd.getCol(3).subVector(0,2);
+        if (!map.isClearlyUnreachable(x))
+            return true;
+
+        Vector x_nearest;
+        if (!reachClamp || !map.getNearestReachable(x,x_nearest))
+            return false;
+
+        if (verbosity>0)
+            yWarning(" *** Arm Solver: target (%s) clamped to (%s)",
+                     x.toString(4,4).c_str(),x_nearest.toString(4,4).c_str());
+
+        Hd.setSubcol(x_nearest,0,3);
+        return true;
+    }
+
+    return true;
+}
+
+
+/****************************************************************/
+bool ArmSolver::solve(const Matrix &Hd_, Vector &q, int *exit_code,
+                      const double deadline, ArmSolverQuality *quality,
+                      ArmSolverStats *stats)
+{
+    if ((Hd_.rows()!=4) || (Hd_.cols()!=4))
     {
         yError("mis-sized desired end-effector frame!");
         return false;
     }
 
+    // clearly unreachable targets are dealt with before Ipopt
+    Matrix Hd=Hd_;
+    if (!screenTarget(Hd))
+    {
+        q=q0;
+        if (exit_code!=NULL)
+            *exit_code=Ipopt::Infeasible_Problem_Detected;
+
+        if (quality!=NULL)
+        {
+            Ipopt::SmartPtr<ArmCommonNLP> nlp=getCache().getNLP(*this,slvParameters);
+            Matrix H=getCache().fkin(*nlp,q,-1,fkinCacheSize,fkinCacheTol);
+            Vector e_u=dcm2axis(Hd*H.transposed());
+            quality->position_error=norm(Hd.getCol(3).subVector(0,2)-H.getCol(3).subVector(0,2));
+            quality->orientation_error=e_u[3];
+            quality->constraint_violation=0.0;
+            quality->iterations=0;
+            quality->best_so_far=false;
+        }
+
+        if (stats!=NULL)
+        {
+            *stats=ArmSolverStats();
+            stats->exit_code=Ipopt::Infeasible_Problem_Detected;
+        }
+
+        if (verbosity>0)
+            yWarning(" *** Arm Solver: target rejected by the reachability map");
+        return false;
+    }
+
     int mode=computeMode();
     int print_level=std::max(verbosity-5,0);
     string warm_start_str="no";    
-
-    Ipopt::SmartPtr<Ipopt::IpoptApplication> app=new Ipopt::IpoptApplication;
-    app->Options()->SetNumericValue("tol",slvParameters.tol);
-    app->Options()->SetNumericValue("constr_viol_tol",slvParameters.constr_tol);
-    app->Options()->SetIntegerValue("acceptable_iter",0);
-    app->Options()->SetStringValue("mu_strategy","monotone");
-    app->Options()->SetIntegerValue("max_iter",slvParameters.max_iter);
-    app->Options()->SetNumericValue("max_cpu_time",slvParameters.max_cpu_time);
-    app->Options()->SetStringValue("nlp_scaling_method","gradient-based");
-    app->Options()->SetNumericValue("nlp_scaling_max_gradient",1.0);
-    app->Options()->SetNumericValue("nlp_scaling_min_value",1e-6);
-    app->Options()->SetStringValue("hessian_approximation","limited-memory");
-    app->Options()->SetStringValue("fixed_variable_treatment","make_parameter");
-    app->Options()->SetStringValue("derivative_test",print_level>=4?"first-order":"none");
-    app->Options()->SetIntegerValue("print_level",print_level);
-    if (slvParameters.warm_start)
+    if (slvParameters.warm_start || slvParameters.tracking)
     {
         if ((zL.length()>0) && (zU.length()>0) && (lambda.length()>0) && (curMode==mode))
-        {
             warm_start_str="yes";
-            app->Options()->SetNumericValue("warm_start_bound_push",1e-6);
-            app->Options()->SetNumericValue("warm_start_mult_bound_push",1e-6);
-            app->Options()->SetNumericValue("mu_init",1e-6);
-        }
         else if (verbosity>0)
             yWarning(" *** Arm Solver: requested \"warm start\" but values are not available => \"warm start\" is disabled!");
     }
-    app->Options()->SetStringValue("warm_start_init_point",warm_start_str.c_str());
-    app->Initialize();
 
-    Ipopt::SmartPtr<ArmCommonNLP> nlp;
-    if (slvParameters.full_pose)
+    // the solver cannot run beyond the deadline
+    SolverParameters params=slvParameters;
+    if (deadline>=0.0)
+        params.max_cpu_time=std::min(params.max_cpu_time,deadline-Time::now());
+    bool expired=(params.max_cpu_time<=0.0);
+
+    Ipopt::SmartPtr<ArmCommonNLP> nlp=getCache().getNLP(*this,slvParameters);
+
+    nlp->set_solver_parameters(slvParameters);
+    nlp->set_warm_start(zL,zU,lambda);
+    nlp->set_target(Hd);
+
+    // in tracking mode the previous solution is a better guess
+    // once moved toward the new target; otherwise, the closest
+    // solved target may be a better guess than q0
+    string seed_str="q0";
+    if (slvParameters.tracking && (prevQ.length()>0) && (curMode==mode))
     {
-        switch (slvParameters.configuration)
-        {
-        case configuration::no_torso_no_heave:
-            if (slvParameters.use_central_difference)
-                nlp=new ArmFullNoTorsoNoHeaveNLP_CentralDiff(*this); 
-            else
-                nlp=new ArmFullNoTorsoNoHeaveNLP_ForwardDiff(*this); 
-            break;
-        case configuration::no_torso_heave:
-            if (slvParameters.use_central_difference)
-                nlp=new ArmFullNoTorsoHeaveNLP_CentralDiff(*this); 
-            else
-                nlp=new ArmFullNoTorsoHeaveNLP_ForwardDiff(*this); 
-            break;
-        case configuration::heave:
-            if (slvParameters.use_central_difference)
-                nlp=new ArmFullHeaveNLP_CentralDiff(*this); 
-            else
-                nlp=new ArmFullHeaveNLP_ForwardDiff(*this); 
-            break;
-        default:
-            if (slvParameters.use_central_difference)
-                nlp=new ArmFullNoHeaveNLP_CentralDiff(*this); 
-            else
-                nlp=new ArmFullNoHeaveNLP_ForwardDiff(*this); 
-        }
+        nlp->set_q0(nlp->predict_q0(prevQ,q0));
+        seed_str="prediction";
     }
     else
     {
-        switch (slvParameters.configuration)
+        Vector seed; double d_seed;
+        if ((seedLibrary!=NULL) && seedLibrary->query(Hd,slvParameters.torso_heave,seed,d_seed) &&
+            (seed.length()==q0.length()))
         {
-        case configuration::no_torso_no_heave:
-            if (slvParameters.use_central_difference)
-                nlp=new ArmXyzNoTorsoNoHeaveNLP_CentralDiff(*this); 
-            else
-                nlp=new ArmXyzNoTorsoNoHeaveNLP_ForwardDiff(*this); 
-            break;
-        case configuration::no_torso_heave:
-            if (slvParameters.use_central_difference)
-                nlp=new ArmXyzNoTorsoHeaveNLP_CentralDiff(*this); 
-            else
-                nlp=new ArmXyzNoTorsoHeaveNLP_ForwardDiff(*this); 
-            break;
-        case configuration::heave:
-            if (slvParameters.use_central_difference)
-                nlp=new ArmXyzHeaveNLP_CentralDiff(*this); 
-            else
-                nlp=new ArmXyzHeaveNLP_ForwardDiff(*this);
-            break;
-        default:
-            if (slvParameters.use_central_difference)
-                nlp=new ArmXyzNoHeaveNLP_CentralDiff(*this); 
-            else
-                nlp=new ArmXyzNoHeaveNLP_ForwardDiff(*this); 
+            // when not optimized, torso and torso yaw are pinned to q0
+            if ((slvParameters.configuration==configuration::no_torso_no_heave) ||
+                (slvParameters.configuration==configuration::no_torso_heave))
+                for (size_t i=0; i<4; i++)
+                    seed[i]=q0[i];
+
+            // both guesses are compared on the poses they attain
+            Matrix H0=getCache().fkin(*nlp,q0,-1,fkinCacheSize,fkinCacheTol);
+            Matrix Hs=getCache().fkin(*nlp,seed,-1,fkinCacheSize,fkinCacheTol);
+            if (seedLibrary->distance(Hd,Hs)<seedLibrary->distance(Hd,H0))
+                seed_str="library";
         }
+
+        nlp->set_q0(seed_str=="library"?seed:q0);
     }
+    nlp->set_cancellation(getCache().cancellation);
+    nlp->set_deadline(deadline);
 
-    nlp->set_q0(q0);
-    nlp->set_warm_start(zL,zU,lambda);
-    nlp->set_target(Hd);
+    // the problem gets wrapped to time the callbacks
+    bool profile=((statsSize>0) || (stats!=NULL));
 
     double t0=Time::now();
-    Ipopt::ApplicationReturnStatus status=app->OptimizeTNLP(GetRawPtr(nlp));
+    Ipopt::ApplicationReturnStatus status=Ipopt::Maximum_CpuTime_Exceeded;
+    if (!expired)
+    {
+        Ipopt::SmartPtr<Ipopt::IpoptApplication> app=getCache().getApplication(params,print_level,warm_start_str);
+        LinearSolverLock lsl(*app);
+
+        // waiting for the lock eats into the budget
+        if (deadline>=0.0)
+        {
+            params.max_cpu_time=std::min(slvParameters.max_cpu_time,deadline-Time::now());
+            expired=(params.max_cpu_time<=0.0);
+            if (!expired)
+                app=getCache().getApplication(params,print_level,warm_start_str);
+        }
+
+        if (!expired)
+        {
+            if (profile)
+            {
+                getCache().profiler->set_nlp(GetRawPtr(nlp));
+                status=app->OptimizeTNLP(GetRawPtr(getCache().profiler));
+            }
+            else
+                status=app->OptimizeTNLP(GetRawPtr(nlp));
+        }
+    }
     double t1=Time::now();
 
     curMode=mode;
-    q=nlp->get_result();
+    q=expired?q0:nlp->get_result();
     nlp->get_warm_start(zL,zU,lambda);    
     if (exit_code!=NULL)
         *exit_code=status;
 
+    bool converged=((status==Ipopt::Solve_Succeeded) ||
+                    (status==Ipopt::Solved_To_Acceptable_Level) ||
+                    (status==Ipopt::Feasible_Point_Found));
+
+    // predictions are built only upon reliable solutions
+    if (converged)
+        prevQ=q;
+    else
+        prevQ.resize(0);
+
+    if (converged && seedLearn && (seedLibrary!=NULL))
+        seedLibrary->add(Hd,slvParameters.torso_heave,q);
+
+    if (profile)
+    {
+        ArmSolverCache &cache=getCache();
+        ArmSolverStats s;
+        if (!expired)
+        {
+            double cost;
+            s=cache.profiler->get_stats();
+            nlp->get_merit(cost,s.constraint_violation);
+            s.iterations=nlp->get_iterations();
+            cache.profiler->set_nlp(NULL);
+        }
+        else
+            s.constraint_violation=std::numeric_limits<double>::max();
+
+        s.exit_code=status;
+        s.warm_start=(warm_start_str=="yes");
+        s.total_time=t1-t0;
+        s.ipopt_time=std::max(s.total_time-s.eval_f_time-s.eval_grad_f_time-
+                              s.eval_g_time-s.eval_jac_g_time-s.eval_h_time,0.0);
+
+        if (statsSize>0)
+            cache.push_stats(s,statsSize);
+        if (stats!=NULL)
+            *stats=s;
+    }
+
+    if (quality!=NULL)
+    {
+        double cost;
+        nlp->get_merit(cost,quality->constraint_violation);
+        quality->iterations=nlp->get_iterations();
+        quality->best_so_far=false;
+
+        // no time left to even assess the initial guess
+        if (expired)
+        {
+            quality->constraint_violation=std::numeric_limits<double>::max();
+            quality->iterations=0;
+        }
+
+        // resort to the best iterate found within the deadline
+        Vector q_best;
+        if (!converged && nlp->get_best(q_best,quality->constraint_violation))
+        {
+            q=q_best;
+            quality->best_so_far=true;
+        }
+
+        Matrix H=getCache().fkin(*nlp,q,-1,fkinCacheSize,fkinCacheTol);
+        Vector e_u=dcm2axis(Hd*H.transposed());
+        quality->position_error=norm(Hd.getCol(3).subVector(0,2)-H.getCol(3).subVector(0,2));
+        quality->orientation_error=e_u[3];
+    }
+
     if (verbosity>0)
     {
         Vector xd=Hd.getCol(3).subVector(0,2);
         Vector ud=dcm2axis(Hd);
 
-        Matrix H=nlp->fkin(q);
+        Matrix H=getCache().fkin(*nlp,q,-1,fkinCacheSize,fkinCacheTol);
         TripodState din1,din2;
         nlp->tripod_fkin(1,q,&din1);
         nlp->tripod_fkin(2,q,&din2);
@@ -250,6 +1070,7 @@ bool ArmSolver::ikin(const Matrix &Hd, Vector &q, int *exit_code)
         yInfo(" *** Arm Solver:              arm = %s",armParameters.upper_arm.getType().c_str());
         yInfo(" *** Arm Solver:             mode = %s",nlp->get_mode().c_str());
         yInfo(" *** Arm Solver:       warm_start = %s",warm_start_str.c_str());
+        yInfo(" *** Arm Solver:             seed = %s",seed_str.c_str());
         yInfo(" *** Arm Solver:          tol [*] = %g",slvParameters.tol);
         yInfo(" *** Arm Solver:   constr_tol [*] = %g",slvParameters.constr_tol);
         yInfo(" *** Arm Solver:     max_iter [#] = %d",slvParameters.max_iter);
@@ -291,6 +1112,447 @@ bool ArmSolver::ikin(const Matrix &Hd, Vector &q, int *exit_code)
 }
 
 
+/****************************************************************/
+bool ArmSolver::fkinAll(const Vector &q, deque<Matrix> &H)
+{
+    iKinChain &chain=*armParameters.upper_arm.asChain();
+    size_t dof=chain.getDOF();
+    size_t L=3+dof+3;
+    if (q.length()<L)
+    {
+        yError("mis-sized DOFs vector!");
+        return false;
+    }
+
+    LockGuard lg(makeThreadSafe);
+
+    TripodKernel k1(armParameters.torso),k2(armParameters.lower_arm);
+    TripodFrame d1,d2;
+    k1.fkin(q.data(),d1);
+    k2.fkin(q.data()+3+dof,d2);
+
+    // matrices already in place are overwritten without reallocation
+    H.resize(dof+3);
+
+    fixed::Hom4 G(d1.T);
+    G.toMatrix(H[0]);
+
+    // joints are clamped within their limits as setAng() does
+    G=G*fixed::Hom4(armParameters.upper_arm.getH0());
+    for (size_t i=0; i<dof; i++)
+    {
+        double theta=std::max(chain[i].getMin(),
+                              std::min(chain[i].getMax(),CTRL_DEG2RAD*q[3+i]));
+        G=G*fixed::dh(chain[i].getA(),chain[i].getD(),chain[i].getAlpha(),
+                      theta+chain[i].getOffset());
+        if (i==dof-1)
+            G=G*fixed::Hom4(armParameters.upper_arm.getHN());
+        G.toMatrix(H[1+i]);
+    }
+
+    G=G*fixed::Hom4(d2.T);
+    G.toMatrix(H[1+dof]);
+
+    G=G*fixed::Hom4(armParameters.TN);
+    G.toMatrix(H[2+dof]);
+
+    return true;
+}
+
+
+/****************************************************************/
+bool ArmSolver::jacobian(const Vector &q, Matrix &J, const int frame)
+{
+    iKinLimb &upper_arm=armParameters.upper_arm;
+    size_t L=3+upper_arm.getDOF()+3;
+    if (q.length()<L)
+    {
+        yError("mis-sized DOFs vector!");
+        return false;
+    }
+
+    LockGuard lg(makeThreadSafe);
+    int dof=upper_arm.getDOF();
+    bool ee=((frame<0) || (frame>=(int)L));
+
+    TripodKernel k1(armParameters.torso),k2(armParameters.lower_arm);
+    TripodFrame d1,d2;
+    TripodJacobian J1,J2;
+    k1.fkin(q.data(),d1);
+    k1.jacobian(q.data(),J1);
+    k2.fkin(q.data()+3+dof,d2);
+    k2.jacobian(q.data()+3+dof,J2);
+
+    Matrix T1(4,4),T2(4,4);
+    for (int i=0; i<4; i++)
+    {
+        for (int j=0; j<4; j++)
+        {
+            T1(i,j)=d1.T[i][j];
+            T2(i,j)=d2.T[i][j];
+        }
+    }
+
+    // pose of the frame
+    upper_arm.setAng(CTRL_DEG2RAD*q.subVector(3,3+dof-1));
+    int n=ee?dof:std::max(0,std::min(frame-3+1,dof));
+    Matrix M=T1*upper_arm.getH(dof-1);
+    Matrix F=T1;
+    if (n>0)
+        F*=upper_arm.getH(n-1);
+    if (ee || (frame>=3+dof))
+        F=M*T2;
+    if (ee)
+        F*=armParameters.TN;
+    Vector pf=F.getCol(3).subVector(0,2);
+
+    J.resize(6,L);
+    J.zero();
+
+    // torso
+    double jw[3][3],jv[3][3];
+    TripodKernel::jacobian(d1,J1,pf.data(),jw,jv);
+    for (int k=0; k<3; k++)
+    {
+        for (int i=0; i<3; i++)
+        {
+            J(i,k)=jv[k][i];
+            J(3+i,k)=jw[k][i];
+        }
+    }
+
+    // upper_arm: the joints up to the frame
+    for (int j=0; j<n; j++)
+    {
+        Matrix Hj=T1*((j==0)?upper_arm.getH0():upper_arm.getH(j-1));
+        Vector z=Hj.getCol(2).subVector(0,2);
+        Vector o=Hj.getCol(3).subVector(0,2);
+
+        J.setSubcol(cross(z,pf-o),0,3+j);
+        J.setSubcol(z,3,3+j);
+    }
+
+    // lower_arm: velocities are mapped through the upstream chain
+    if (ee || (frame>=3+dof))
+    {
+        Matrix R=M.submatrix(0,2,0,2);
+        Vector p2=R.transposed()*(pf-M.getCol(3).subVector(0,2));
+        TripodKernel::jacobian(d2,J2,p2.data(),jw,jv);
+        for (int k=0; k<3; k++)
+        {
+            Vector w(3),v(3);
+            for (int i=0; i<3; i++)
+            {
+                w[i]=jw[k][i];
+                v[i]=jv[k][i];
+            }
+
+            J.setSubcol(R*v,0,3+dof+k);
+            J.setSubcol(R*w,3,3+dof+k);
+        }
+    }
+
+    return true;
+}
+
+
+/****************************************************************/
+bool ArmSolver::ikin(const Matrix &Hd, Vector &q, int *exit_code)
+{
+    LockGuard lg(makeThreadSafe);
+    return solve(Hd,q,exit_code,-1.0,NULL);
+}
+
+
+/****************************************************************/
+bool ArmSolver::ikin(const Matrix &Hd, Vector &q, const double deadline,
+                     ArmSolverQuality &quality, int *exit_code)
+{
+    LockGuard lg(makeThreadSafe);
+    return solve(Hd,q,exit_code,std::max(deadline,0.0),&quality);
+}
+
+
+/****************************************************************/
+bool ArmSolver::ikin(const Matrix &Hd, Vector &q, ArmSolverStats &stats,
+                     int *exit_code)
+{
+    LockGuard lg(makeThreadSafe);
+    return solve(Hd,q,exit_code,-1.0,NULL,&stats);
+}
+
+
+/****************************************************************/
+bool ArmSolver::ikinDiff(const Matrix &Hd, const Vector &q, Vector &q_next,
+                         const double damping)
+{
+    if ((Hd.rows()!=4) || (Hd.cols()!=4))
+    {
+        yError("mis-sized desired end-effector frame!");
+        return false;
+    }
+
+    size_t L=3+armParameters.upper_arm.getDOF()+3;
+    if (q.length()<L)
+    {
+        yError("mis-sized DOFs vector!");
+        return false;
+    }
+
+    LockGuard lg(makeThreadSafe);
+    Ipopt::SmartPtr<ArmCommonNLP> nlp=getCache().getNLP(*this,slvParameters);
+
+    nlp->set_solver_parameters(slvParameters);
+    nlp->set_target(Hd);
+    q_next=nlp->differential_step(q,q,damping);
+
+    return true;
+}
+
+
+/****************************************************************/
+bool ArmSolver::ikinMultiStart(const Matrix &Hd, Vector &q, const int starts,
+                               int *exit_code)
+{
+    if ((Hd.rows()!=4) || (Hd.cols()!=4))
+    {
+        yError("mis-sized desired end-effector frame!");
+        return false;
+    }
+
+    // the pool is owned by the cache, hence we hold the lock
+    // throughout the solution
+    LockGuard lg(makeThreadSafe);
+    ArmSolverCache &cache=getCache();
+
+    size_t n=(size_t)std::max(starts,1);
+    while (cache.workers.size()<n)
+        cache.workers.push_back(new ArmSolver(*this));
+
+    // seeds: the current initial guess, the midpoints of the
+    // joints ranges and random configurations within the bounds;
+    // when not optimized, torso and torso yaw are pinned to q0
+    bool moving_torso=(slvParameters.configuration!=configuration::no_torso_no_heave) &&
+                      (slvParameters.configuration!=configuration::no_torso_heave);
+
+    deque<Vector> seeds;
+    seeds.push_back(q0);
+    if (n>1)
+    {
+        Vector seed=cache.getNLP(*this,slvParameters)->get_midpoints();
+        if (!moving_torso)
+            for (size_t i=0; i<4; i++)
+                seed[i]=q0[i];
+
+        seeds.push_back(seed);
+    }
+
+    iKinChain &chain=*armParameters.upper_arm.asChain();
+    size_t L=3+chain.getDOF();
+    while (seeds.size()<n)
+    {
+        Vector seed(L+3);
+        for (size_t i=0; i<3; i++)
+        {
+            seed[i]=moving_torso?Rand::scalar(armParameters.torso.l_min,armParameters.torso.l_max):q0[i];
+            seed[L+i]=Rand::scalar(armParameters.lower_arm.l_min,armParameters.lower_arm.l_max);
+        }
+
+        for (size_t i=0; i<chain.getDOF(); i++)
+        {
+            if (moving_torso || (i>0))
+                seed[3+i]=CTRL_RAD2DEG*Rand::scalar(chain[i].getMin(),chain[i].getMax());
+            else
+                seed[3+i]=q0[3+i];
+        }
+
+        seeds.push_back(seed);
+    }
+
+    // starts are independent, thus no warm start
+    SolverParameters params=slvParameters;
+    params.warm_start=false;
+    params.tracking=false;
+
+    // with a non-reentrant linear solver the starts would be
+    // serialized anyway in whatever order they grab the lock,
+    // hence we run them in turn from q0, stopping at the first
+    // that converges, which keeps the outcome deterministic
+    bool serialized=LinearSolverLock::serializes(params.linear_solver);
+
+    CancellationToken token;
+    deque<Vector> qs(n);
+    deque<int> exit_codes(n,Ipopt::Internal_Error);
+    deque<ArmMultiStartWorker*> threads;
+    deque<bool> converged(n,false);
+    bool any_converged=false;
+    for (size_t i=0; i<n; i++)
+    {
+        ArmSolver *solver=cache.workers[i];
+        solver->setSolverParameters(params);
+        solver->setVerbosity(verbosity);
+        solver->setInitialGuess(seeds[i]);
+        solver->disableIterateCallback();
+
+        // starts must depart from their own seeds, but the workers
+        // are shared with ikinBatch(), which restores the library
+        solver->disableSeedLibrary();
+
+        if (serialized)
+        {
+            if (!any_converged)
+            {
+                converged[i]=solver->ikin(Hd,qs[i],&exit_codes[i]);
+                any_converged=converged[i];
+            }
+        }
+        else
+        {
+            solver->getCache().cancellation=&token;
+            threads.push_back(new ArmMultiStartWorker(*solver,token,Hd,qs[i],exit_codes[i]));
+            threads.back()->start();
+        }
+    }
+
+    for (size_t i=0; i<threads.size(); i++)
+    {
+        threads[i]->join();
+        converged[i]=threads[i]->succeeded();
+        any_converged|=converged[i];
+        cache.workers[i]->getCache().cancellation=NULL;
+        delete threads[i];
+    }
+
+    // the costs are not comparable across starts, as the postural
+    // terms are measured from each start's own seed; we pick then
+    // the lowest pose error plus constraints violation, giving
+    // precedence to the starts that did converge
+    size_t best=0;
+    double best_merit=std::numeric_limits<double>::max();
+    for (size_t i=0; i<n; i++)
+    {
+        if ((qs[i].length()==0) || (any_converged && !converged[i]))
+            continue;
+
+        ArmSolver *solver=cache.workers[i];
+        double cost,violation;
+        solver->getCache().getNLP(*solver,params)->get_merit(cost,violation);
+
+        Matrix H;
+        solver->fkin(qs[i],H);
+        double error=norm(Hd.getCol(3).subVector(0,2)-H.getCol(3).subVector(0,2));
+        if (params.full_pose)
+            error+=fabs(dcm2axis(Hd*SE3inv(H))[3]);
+
+        if (error+violation<best_merit)
+        {
+            best_merit=error+violation;
+            best=i;
+        }
+    }
+
+    ArmSolver *solver=cache.workers[best];
+    if (qs[best].length()>0)
+        q=qs[best];
+
+    // retain the multipliers for the following warm starts
+    zL=solver->zL;
+    zU=solver->zU;
+    lambda=solver->lambda;
+    curMode=solver->curMode;
+    if (converged[best])
+        prevQ=q;
+    else
+        prevQ.resize(0);
+
+    if (exit_code!=NULL)
+        *exit_code=exit_codes[best];
+
+    if (verbosity>0)
+        yInfo(" *** Arm Solver: multi-start picked start #%d out of %d (pose error+violation = %g)",
+              (int)best,(int)n,best_merit);
+
+    return converged[best];
+}
+
+
+/****************************************************************/
+bool ArmSolver::ikinBatch(const deque<Matrix> &Hd, deque<Vector> &q,
+                          deque<int> &exit_codes, deque<double> &timings,
+                          const deque<double> &heave, const deque<Vector> &q0,
+                          const int workers)
+{
+    if ((heave.size()>0) && (heave.size()!=Hd.size()))
+    {
+        yError("mis-sized heave values!");
+        return false;
+    }
+
+    if ((q0.size()>0) && (q0.size()!=Hd.size()))
+    {
+        yError("mis-sized initial guesses!");
+        return false;
+    }
+
+    // outputs are filled in place by the workers
+    q.assign(Hd.size(),Vector());
+    exit_codes.assign(Hd.size(),Ipopt::Internal_Error);
+    timings.assign(Hd.size(),0.0);
+    if (Hd.size()==0)
+        return true;
+
+    // the pool is owned by the cache, hence we hold the lock
+    // throughout the batch
+    LockGuard lg(makeThreadSafe);
+    ArmSolverCache &cache=getCache();
+
+    size_t n=std::min((size_t)std::max(workers,1),Hd.size());
+    while (cache.workers.size()<n)
+        cache.workers.push_back(new ArmSolver(*this));
+
+    // targets are unrelated to each other, thus no warm start
+    SolverParameters params=slvParameters;
+    params.warm_start=false;
+    params.tracking=false;
+
+    BatchDispatcher dispatcher(Hd.size());
+    deque<ArmBatchWorker*> threads;
+    for (size_t i=0; i<n; i++)
+    {
+        ArmSolver *solver=cache.workers[i];
+        solver->setSolverParameters(params);
+        solver->setVerbosity(verbosity);
+        solver->setInitialGuess(this->q0);
+        solver->disableIterateCallback();
+        if (seedLibrary!=NULL)
+            solver->enableSeedLibrary(*seedLibrary,seedLearn);
+        else
+            solver->disableSeedLibrary();
+
+        threads.push_back(new ArmBatchWorker(*solver,dispatcher,Hd,heave,q0,
+                                             q,exit_codes,timings));
+        threads.back()->start();
+    }
+
+    bool ret=true;
+    for (size_t i=0; i<threads.size(); i++)
+    {
+        threads[i]->join();
+        ret&=threads[i]->succeeded();
+        delete threads[i];
+    }
+
+    return ret;
+}
+
+
+/****************************************************************/
+ArmSolver::~ArmSolver()
+{
+    delete cache;
+}
+
+
 /****************************************************************/
 ArmCOM::ArmCOM(ArmSolver &solver_, const double external_weight,
                const double floor_z) : solver(solver_)
@@ -332,16 +1594,12 @@ ArmCOM::ArmCOM(ArmSolver &solver_, const double external_weight,
     // compute CoMs relative positions wrt q0
     Vector q0(12,0.0);
 
-    Matrix frame;
-    solver.fkin(q0,frame,3+0);
-    relComs[1]=SE3inv(frame)*relComs[1];
-    relComs[2]=SE3inv(frame)*relComs[2];
-
-    solver.fkin(q0,frame,3+3);        
-    relComs[3]=SE3inv(frame)*relComs[3];
-
-    solver.fkin(q0,frame,3+5);
-    relComs[4]=SE3inv(frame)*relComs[4];
+    deque<Matrix> frames;
+    solver.fkinAll(q0,frames);
+    relComs[1]=SE3inv(frames[1+0])*relComs[1];
+    relComs[2]=SE3inv(frames[1+0])*relComs[2];
+    relComs[3]=SE3inv(frames[1+3])*relComs[3];
+    relComs[4]=SE3inv(frames[1+5])*relComs[4];
 
     // hand
     tmp[0]=tmp[1]=tmp[2]=0.0;
@@ -410,19 +1668,13 @@ bool ArmCOM::getCOMs(const Vector &q, deque<Vector> &coms) const
     coms.clear(); 
     coms.push_back(relComs[0]);
 
-    Matrix frame;
-    solver.fkin(q,frame,3+0);
-    coms.push_back(frame*relComs[1]);
-    coms.push_back(frame*relComs[2]);
-
-    solver.fkin(q,frame,3+3);
-    coms.push_back(frame*relComs[3]);
-
-    solver.fkin(q,frame,3+5);
-    coms.push_back(frame*relComs[4]);
-
-    solver.fkin(q,frame);
-    coms.push_back(frame*relComs[5]);
+    deque<Matrix> frames;
+    solver.fkinAll(q,frames);
+    coms.push_back(frames[1+0]*relComs[1]);
+    coms.push_back(frames[1+0]*relComs[2]);
+    coms.push_back(frames[1+3]*relComs[3]);
+    coms.push_back(frames[1+5]*relComs[4]);
+    coms.push_back(frames.back()*relComs[5]);
 
     Vector com_tot(4,0.0);
     for (size_t i=0; i<coms.size(); i++)
@@ -16,11 +16,16 @@
 */
 
 #include <cmath>
+#include <string>
+#include <set>
+#include <map>
+#include <deque>
 #include <algorithm>
 
 #include <yarp/os/Log.h>
 #include <yarp/os/Time.h>
 #include <yarp/os/LockGuard.h>
+#include <yarp/os/Thread.h>
 #include <yarp/math/Math.h>
 
 #include <iCub/ctrl/math.h>
@@ -30,6 +35,8 @@
 #include <IpIpoptApplication.hpp>
 
 #include <cer_kinematics/head.h>
+#include <cer_kinematics/private/helpers.h>
+#include <cer_kinematics/private/fixed_math.h>
 
 using namespace std;
 using namespace yarp::os;
@@ -49,17 +56,35 @@ protected:
     HeadSolver &slv;
     HeadParameters &params;
     
-    Matrix H0,T,Hxd;
-    Matrix GeoJacobP,AnaJacobZ;
+    Matrix T;
     Vector xd,q0,q;
     double mod,cosAng;
     double e_ang;
 
+    // fixed-size quantities the callbacks rely on to avoid
+    // heap allocations while iterating
+    double A[3],D[3],alpha[3],offset[3];
+    fixed::Hom4 H0,HN,T_;
+    fixed::Vec3 xd_;
+    fixed::Vec3 d,z;
+    fixed::Vec3 w[2],dp[2],dz[2];
+
 public:
     /****************************************************************/
     HeadNLP(HeadSolver &slv_) : slv(slv_), params(slv_.headParameters)
     {
-        H0=params.head.getH0();
+        H0=fixed::Hom4(params.head.getH0());
+        HN=fixed::Hom4(params.head.getHN());
+
+        iKinChain &chain=*params.head.asChain();
+        for (size_t i=0; i<3; i++)
+        {
+            A[i]=chain[i].getA();
+            D[i]=chain[i].getD();
+            alpha[i]=chain[i].getAlpha();
+            offset[i]=chain[i].getOffset();
+        }
+
         xd.resize(3,0.0);
         q0.resize(3+params.head.getDOF(),0.0);
         set_q0(q0);
@@ -82,7 +107,12 @@ public:
         for (size_t i=0; i<l2; i++)
             this->q0[3+i]=std::max(chain[i].getMin(),std::min(chain[i].getMax(),CTRL_DEG2RAD*q0[3+i]));
 
-        slv.fkin(this->q0,T,2);
+        // the torso platform in closed form
+        TripodKernel kernel(params.torso);
+        TripodFrame d1;
+        kernel.fkin(this->q0.data(),d1);
+        T_=fixed::Hom4(d1.T);
+        T_.toMatrix(T);
     }
 
     /****************************************************************/
@@ -90,7 +120,7 @@ public:
     {
         size_t len=std::min(this->xd.length(),xd.length());
         for (size_t i=0; i<len; i++)
-            this->xd[i]=xd[i];
+            this->xd[i]=xd_[i]=xd[i];
     }
 
     /****************************************************************/
@@ -100,12 +130,94 @@ public:
         return q;
     }
 
+    /****************************************************************/
+    bool solve_newton(const int max_iter, const double tol)
+    {
+        // projected Newton on the box of the neck bounds, relying on
+        // the same exact derivatives that are provided to Ipopt
+        double x_l[2],x_u[2],x[2];
+        get_bounds_info(2,x_l,x_u,0,NULL,NULL);
+        get_starting_point(2,true,x,false,NULL,NULL,0,false,NULL);
+
+        for (int iter=0; iter<max_iter; iter++)
+        {
+            double f,g[2],h[3];
+            eval_f(2,x,true,f);
+            eval_grad_f(2,x,false,g);
+            eval_h(2,x,false,1.0,0,NULL,false,3,NULL,NULL,h);
+
+            // variables lying on a bound and pushed outward are held
+            bool held[2];
+            double pg=0.0;
+            for (int i=0; i<2; i++)
+            {
+                held[i]=((x[i]<=x_l[i]) && (g[i]>0.0)) ||
+                        ((x[i]>=x_u[i]) && (g[i]<0.0));
+                if (!held[i])
+                    pg=std::max(pg,fabs(g[i]));
+            }
+
+            // stationary points looking away from the target are
+            // left to Ipopt
+            if (pg<tol)
+            {
+                if (f>=0.0)
+                    return false;
+
+                finalize_solution(Ipopt::SUCCESS,2,x,NULL,NULL,0,NULL,NULL,
+                                  f,NULL,NULL);
+                return true;
+            }
+
+            // Newton direction where the Hessian is positive definite,
+            // steepest descent otherwise
+            double dx[2]={0.0,0.0};
+            double det=h[0]*h[2]-h[1]*h[1];
+            if (!held[0] && !held[1] && (h[0]>0.0) && (det>0.0))
+            {
+                dx[0]=-(h[2]*g[0]-h[1]*g[1])/det;
+                dx[1]=-(h[0]*g[1]-h[1]*g[0])/det;
+            }
+            else
+            {
+                double hii[2]={h[0],h[2]};
+                for (int i=0; i<2; i++)
+                    if (!held[i])
+                        dx[i]=(hii[i]>0.0)?-g[i]/hii[i]:-g[i];
+            }
+
+            // backtracking along the projected path
+            bool descent=false;
+            for (double t=1.0; t>1e-6; t*=0.5)
+            {
+                double xn[2],fn;
+                for (int i=0; i<2; i++)
+                    xn[i]=std::max(x_l[i],std::min(x_u[i],x[i]+t*dx[i]));
+                eval_f(2,xn,true,fn);
+
+                if (fn<=f+1e-4*(g[0]*(xn[0]-x[0])+g[1]*(xn[1]-x[1])))
+                {
+                    x[0]=xn[0];
+                    x[1]=xn[1];
+                    descent=true;
+                    break;
+                }
+            }
+
+            if (!descent)
+                break;
+        }
+
+        return false;
+    }
+
     /****************************************************************/
     bool get_nlp_info(Ipopt::Index &n, Ipopt::Index &m, Ipopt::Index &nnz_jac_g,
                       Ipopt::Index &nnz_h_lag, IndexStyleEnum &index_style)
     {
         n=2;
-        m=nnz_jac_g=nnz_h_lag=0;
+        m=nnz_jac_g=0;
+        nnz_h_lag=slv.slvParameters.use_hessian?3:0;
         index_style=TNLP::C_STYLE;
         return true;
     }
@@ -139,21 +251,34 @@ public:
     {        
         if (new_x)
         {
-            iKinChain &chain=*params.head.asChain();
-            chain.setAng(1,x[0]);
-            chain.setAng(2,x[1]);
-            Hxd=T*chain.getH();
-            Hxd(0,3)-=xd[0];
-            Hxd(1,3)-=xd[1];
-            Hxd(2,3)-=xd[2];
-            Hxd(3,3)=0.0;
-            mod=norm(Hxd,3);
-            cosAng=dot(Hxd,2,Hxd,3)/mod;
-
-            chain.setH0(T);
-            GeoJacobP=chain.GeoJacobian();
-            AnaJacobZ=chain.AnaJacobian(2);
-            chain.setH0(H0);
+            double ang[3];
+            ang[0]=q0[3]; ang[1]=x[0]; ang[2]=x[1];
+
+            // z-axes and origins of the joints' frames collected
+            // while walking the DH chain
+            fixed::Vec3 zj[3],oj[3];
+            fixed::Hom4 G=T_*H0;
+            for (int i=0; i<3; i++)
+            {
+                zj[i]=G.getCol(2);
+                oj[i]=G.position();
+                G=G*fixed::dh(A[i],D[i],alpha[i],ang[i]+offset[i]);
+            }
+            G=G*HN;
+
+            z=G.getCol(2);
+            d=G.position()-xd_;
+            mod=norm(d);
+            cosAng=dot(z,d)/mod;
+
+            // for revolute joints: dp/dqj=wj x (p-oj) and dz/dqj=wj x z
+            fixed::Vec3 p=G.position();
+            for (int i=0; i<2; i++)
+            {
+                w[i]=zj[1+i];
+                dp[i]=cross(w[i],p-oj[1+i]);
+                dz[i]=cross(w[i],z);
+            }
         }
     }
 
@@ -172,11 +297,8 @@ public:
     {
         computeQuantities(x,new_x);
         for (Ipopt::Index i=0; i<n; i++)
-        {
-            Ipopt::Index j=i+1;
-            grad_f[i]=(dot(AnaJacobZ,j,Hxd,3)+dot(Hxd,2,GeoJacobP,j))/mod
-                      -(cosAng*dot(Hxd,3,GeoJacobP,j))/(mod*mod);
-        }
+            grad_f[i]=(dot(dz[i],d)+dot(z,dp[i]))/mod
+                      -(cosAng*dot(d,dp[i]))/(mod*mod);
         return true;
     }
 
@@ -201,6 +323,44 @@ public:
                 bool new_lambda, Ipopt::Index nele_hess, Ipopt::Index *iRow,
                 Ipopt::Index *jCol, Ipopt::Number *values)
     {
+        if (values==NULL)
+        {
+            iRow[0]=0; jCol[0]=0;
+            iRow[1]=1; jCol[1]=0;
+            iRow[2]=1; jCol[2]=1;
+        }
+        else
+        {
+            computeQuantities(x,new_x);
+
+            // cosAng=a/mod, with a=z'*d and mod=|d|
+            double a=cosAng*mod;
+
+            double da[2],dmod[2];
+            for (int i=0; i<2; i++)
+            {
+                da[i]=dot(dz[i],d)+dot(z,dp[i]);
+                dmod[i]=dot(d,dp[i])/mod;
+            }
+
+            // for revolute joints, with i upstream of j:
+            // d2p/dqi*dqj=wi x dp/dqj and d2z/dqi*dqj=wi x dz/dqj
+            Ipopt::Index idx=0;
+            for (int j=0; j<2; j++)
+            {
+                for (int i=0; i<=j; i++)
+                {
+                    fixed::Vec3 ddp=cross(w[i],dp[j]);
+                    fixed::Vec3 ddz=cross(w[i],dz[j]);
+                    double dda=dot(ddz,d)+dot(dz[i],dp[j])+dot(dz[j],dp[i])+dot(z,ddp);
+                    double ddmod=(dot(dp[i],dp[j])+dot(d,ddp)-dmod[i]*dmod[j])/mod;
+
+                    values[idx++]=obj_factor*(dda/mod-(da[i]*dmod[j]+da[j]*dmod[i])/(mod*mod)
+                                              -a*ddmod/(mod*mod)+2.0*a*dmod[i]*dmod[j]/(mod*mod*mod));
+                }
+            }
+        }
+
         return true;
     }
 
@@ -222,6 +382,51 @@ public:
     }
 };
 
+
+/****************************************************************/
+class HeadBatchWorker : public Thread
+{
+    HeadSolver &solver;
+    BatchDispatcher &dispatcher;
+    const deque<Vector> &xd;
+    const deque<Vector> &q0;
+    deque<Vector> &q;
+    deque<int> &exit_codes;
+    deque<double> &timings;
+    bool ret;
+
+    /****************************************************************/
+    void run()
+    {
+        size_t i;
+        while (dispatcher.pop(i))
+        {
+            if (q0.size()>0)
+                ret&=solver.setInitialGuess(q0[i]);
+
+            double t0=Time::now();
+            ret&=solver.ikin(xd[i],q[i],&exit_codes[i]);
+            timings[i]=Time::now()-t0;
+        }
+    }
+
+public:
+    /****************************************************************/
+    HeadBatchWorker(HeadSolver &solver_, BatchDispatcher &dispatcher_,
+                    const deque<Vector> &xd_, const deque<Vector> &q0_,
+                    deque<Vector> &q_, deque<int> &exit_codes_,
+                    deque<double> &timings_) :
+                    solver(solver_), dispatcher(dispatcher_), xd(xd_),
+                    q0(q0_), q(q_), exit_codes(exit_codes_),
+                    timings(timings_), ret(true) { }
+
+    /****************************************************************/
+    bool succeeded() const
+    {
+        return ret;
+    }
+};
+
 }
 
 }
@@ -247,11 +452,20 @@ HeadSolver::HeadSolver(const HeadParameters &headParams,
 /****************************************************************/
 void HeadSolver::setHeadParameters(const HeadParameters &params)
 {
+    LockGuard lg(makeThreadSafe);
     headParameters=params;
     torso.setParameters(headParameters.torso);
 }
 
 
+/****************************************************************/
+void HeadSolver::setBranchParameters(const HeadParameters &params)
+{
+    LockGuard lg(makeThreadSafe);
+    branches[params.head.getType()]=params;
+}
+
+
 /****************************************************************/
 void HeadSolver::setVerbosity(const int verb)
 {
@@ -285,7 +499,7 @@ bool HeadSolver::fkin(const Vector &q, Matrix &H, const int frame)
         return false;
     }
 
-    torso.fkin(q.subVector(0,2),H);
+    torso.fkin(q,H);
     headParameters.head.setAng(CTRL_DEG2RAD*q.subVector(3,5));
 
     int frame_=(frame<0)?L-1:frame;
@@ -296,6 +510,124 @@ bool HeadSolver::fkin(const Vector &q, Matrix &H, const int frame)
 }
 
 
+/****************************************************************/
+bool HeadSolver::fkinAll(const Vector &q, map<string,Matrix> &H)
+{
+    iKinChain &chain=*headParameters.head.asChain();
+    size_t dof=chain.getDOF();
+    size_t L=3+dof;
+    if (q.length()<L)
+    {
+        yError("mis-sized DOFs vector!");
+        return false;
+    }
+
+    LockGuard lg(makeThreadSafe);
+    set<string> types=HeadParameters::getTypes();
+    if (branches.size()<types.size())
+        for (set<string>::iterator it=types.begin(); it!=types.end(); it++)
+            if (branches.find(*it)==branches.end())
+                branches[*it]=HeadParameters(*it);
+
+    TripodKernel k1(headParameters.torso);
+    TripodFrame d1;
+    k1.fkin(q.data(),d1);
+
+    // torso and neck are shared by all the types, while joints
+    // are clamped within their limits as setAng() does
+    fixed::Hom4 G=fixed::Hom4(d1.T)*fixed::Hom4(headParameters.head.getH0());
+    for (size_t i=0; i<dof-1; i++)
+    {
+        double theta=std::max(chain[i].getMin(),
+                              std::min(chain[i].getMax(),CTRL_DEG2RAD*q[3+i]));
+        G=G*fixed::dh(chain[i].getA(),chain[i].getD(),chain[i].getAlpha(),
+                      theta+chain[i].getOffset());
+    }
+
+    for (map<string,HeadParameters>::iterator it=branches.begin(); it!=branches.end(); it++)
+    {
+        iKinLimb &head=(it->first==headParameters.head.getType())?
+                       headParameters.head:it->second.head;
+        iKinLink &link=(*head.asChain())[dof-1];
+
+        double theta=std::max(link.getMin(),
+                              std::min(link.getMax(),CTRL_DEG2RAD*q[3+dof-1]));
+        fixed::Hom4 T=G*fixed::dh(link.getA(),link.getD(),link.getAlpha(),
+                                  theta+link.getOffset());
+        T=T*fixed::Hom4(head.getHN());
+
+        // matrices already in place are overwritten without reallocation
+        T.toMatrix(H[it->first]);
+    }
+
+    return true;
+}
+
+
+/****************************************************************/
+bool HeadSolver::jacobian(const Vector &q, Matrix &J, const int frame)
+{
+    iKinLimb &head=headParameters.head;
+    size_t L=3+head.getDOF();
+    if (q.length()<L)
+    {
+        yError("mis-sized DOFs vector!");
+        return false;
+    }
+
+    LockGuard lg(makeThreadSafe);
+    int dof=head.getDOF();
+
+    TripodKernel k1(headParameters.torso);
+    TripodFrame d1;
+    TripodJacobian J1;
+    k1.fkin(q.data(),d1);
+    k1.jacobian(q.data(),J1);
+
+    Matrix T1(4,4);
+    for (int i=0; i<4; i++)
+        for (int j=0; j<4; j++)
+            T1(i,j)=d1.T[i][j];
+
+    // pose of the frame
+    head.setAng(CTRL_DEG2RAD*q.subVector(3,3+dof-1));
+    int frame_=(frame<0)?L-1:frame;
+    int n=std::max(0,std::min(frame_-3+1,dof));
+    Matrix F=T1;
+    if (n>0)
+        F*=head.getH(n-1);
+    Vector pf=F.getCol(3).subVector(0,2);
+
+    J.resize(6,L);
+    J.zero();
+
+    // torso
+    double jw[3][3],jv[3][3];
+    TripodKernel::jacobian(d1,J1,pf.data(),jw,jv);
+    for (int k=0; k<3; k++)
+    {
+        for (int i=0; i<3; i++)
+        {
+            J(i,k)=jv[k][i];
+            J(3+i,k)=jw[k][i];
+        }
+    }
+
+    // head: the joints up to the frame
+    for (int j=0; j<n; j++)
+    {
+        Matrix Hj=T1*((j==0)?head.getH0():head.getH(j-1));
+        Vector z=Hj.getCol(2).subVector(0,2);
+        Vector o=Hj.getCol(3).subVector(0,2);
+
+        J.setSubcol(cross(z,pf-o),0,3+j);
+        J.setSubcol(z,3,3+j);
+    }
+
+    return true;
+}
+
+
 /****************************************************************/
 bool HeadSolver::ikin(const Vector &xd, Vector &q, int *exit_code)
 {
@@ -308,24 +640,34 @@ bool HeadSolver::ikin(const Vector &xd, Vector &q, int *exit_code)
 
     int print_level=std::max(verbosity-5,0);
 
-    Ipopt::SmartPtr<Ipopt::IpoptApplication> app=new Ipopt::IpoptApplication;
-    app->Options()->SetNumericValue("tol",slvParameters.tol);
-    app->Options()->SetNumericValue("constr_viol_tol",slvParameters.constr_tol);
-    app->Options()->SetIntegerValue("acceptable_iter",0);
-    app->Options()->SetStringValue("mu_strategy","adaptive");
-    app->Options()->SetIntegerValue("max_iter",slvParameters.max_iter);
-    app->Options()->SetNumericValue("max_cpu_time",slvParameters.max_cpu_time);
-    app->Options()->SetStringValue("hessian_approximation","limited-memory");
-    app->Options()->SetStringValue("derivative_test",print_level>=4?"first-order":"none");
-    app->Options()->SetIntegerValue("print_level",print_level);
-    app->Initialize();
-
     Ipopt::SmartPtr<HeadNLP> nlp=new HeadNLP(*this);
     nlp->set_q0(q0);
     nlp->set_xd(xd);
 
+    // the fixation problem is tackled first with a few Newton
+    // iterations, while Ipopt is the fallback for the edge cases
     double t0=Time::now();
-    Ipopt::ApplicationReturnStatus status=app->OptimizeTNLP(GetRawPtr(nlp));
+    string method="newton";
+    Ipopt::ApplicationReturnStatus status=Ipopt::Solve_Succeeded;
+    if (!nlp->solve_newton(10,1e-9))
+    {
+        Ipopt::SmartPtr<Ipopt::IpoptApplication> app=new Ipopt::IpoptApplication;
+        app->Options()->SetNumericValue("tol",slvParameters.tol);
+        app->Options()->SetNumericValue("constr_viol_tol",slvParameters.constr_tol);
+        app->Options()->SetIntegerValue("acceptable_iter",0);
+        app->Options()->SetStringValue("mu_strategy","adaptive");
+        app->Options()->SetIntegerValue("max_iter",slvParameters.max_iter);
+        app->Options()->SetNumericValue("max_cpu_time",slvParameters.max_cpu_time);
+        app->Options()->SetStringValue("hessian_approximation",slvParameters.use_hessian?"exact":"limited-memory");
+        app->Options()->SetStringValue("linear_solver",slvParameters.linear_solver.c_str());
+        app->Options()->SetStringValue("derivative_test",print_level>=4?"first-order":"none");
+        app->Options()->SetIntegerValue("print_level",print_level);
+        app->Initialize();
+
+        method="ipopt";
+        LinearSolverLock lsl(*app);
+        status=app->OptimizeTNLP(GetRawPtr(nlp));
+    }
     double t1=Time::now();
 
     double e_ang;
@@ -337,6 +679,7 @@ bool HeadSolver::ikin(const Vector &xd, Vector &q, int *exit_code)
     {
         yInfo(" *** Head Solver ******************************");
         yInfo(" *** Head Solver:             head = %s",headParameters.head.getType().c_str());
+        yInfo(" *** Head Solver:           method = %s",method.c_str());
         yInfo(" *** Head Solver:          tol [*] = %g",slvParameters.tol);
         yInfo(" *** Head Solver:   constr_tol [*] = %g",slvParameters.constr_tol);
         yInfo(" *** Head Solver:     max_iter [#] = %d",slvParameters.max_iter);
@@ -384,3 +727,56 @@ bool HeadSolver::ikin(const Matrix &Hd, Vector &q, int *exit_code)
     return ikin(Hd.getCol(3).subVector(0,2),q,exit_code);
 }
 
+
+/****************************************************************/
+bool HeadSolver::ikinBatch(const deque<Vector> &xd, deque<Vector> &q,
+                           deque<int> &exit_codes, deque<double> &timings,
+                           const deque<Vector> &q0, const int workers)
+{
+    if ((q0.size()>0) && (q0.size()!=xd.size()))
+    {
+        yError("mis-sized initial guesses!");
+        return false;
+    }
+
+    // outputs are filled in place by the workers
+    q.assign(xd.size(),Vector());
+    exit_codes.assign(xd.size(),Ipopt::Internal_Error);
+    timings.assign(xd.size(),0.0);
+    if (xd.size()==0)
+        return true;
+
+    // the head problem is built anew at each call, hence
+    // clones are cheap and do not need to persist
+    deque<HeadSolver*> solvers;
+    {
+        LockGuard lg(makeThreadSafe);
+        size_t n=std::min((size_t)std::max(workers,1),xd.size());
+        for (size_t i=0; i<n; i++)
+        {
+            solvers.push_back(new HeadSolver(*this));
+            solvers.back()->disableIterateCallback();
+        }
+    }
+
+    BatchDispatcher dispatcher(xd.size());
+    deque<HeadBatchWorker*> threads;
+    for (size_t i=0; i<solvers.size(); i++)
+    {
+        threads.push_back(new HeadBatchWorker(*solvers[i],dispatcher,xd,q0,
+                                              q,exit_codes,timings));
+        threads.back()->start();
+    }
+
+    bool ret=true;
+    for (size_t i=0; i<threads.size(); i++)
+    {
+        threads[i]->join();
+        ret&=threads[i]->succeeded();
+        delete threads[i];
+        delete solvers[i];
+    }
+
+    return ret;
+}
+
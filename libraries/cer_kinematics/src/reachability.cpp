@@ -0,0 +1,404 @@
+/*
+ * Copyright (C) 2015 iCub Facility - Istituto Italiano di Tecnologia
+ * Author: Ugo Pattacini
+ * email:  ugo.pattacini@iit.it
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <deque>
+#include <fstream>
+
+#include <yarp/os/Log.h>
+#include <yarp/sig/Vector.h>
+#include <yarp/sig/Matrix.h>
+#include <yarp/math/Math.h>
+
+#include <iCub/ctrl/math.h>
+
+#include <cer_kinematics/reachability.h>
+
+#define REACHABILITY_MAGIC      "CERREACH"
+#define REACHABILITY_TOL_HEAVE  1e-3
+
+using namespace std;
+using namespace yarp::os;
+using namespace yarp::sig;
+using namespace yarp::math;
+using namespace iCub::ctrl;
+using namespace cer::kinematics;
+
+
+/****************************************************************/
+static void writeString(ofstream &fout, const string &str)
+{
+    int len=(int)str.length();
+    fout.write((const char*)&len,sizeof(len));
+    fout.write(str.c_str(),len);
+}
+
+
+/****************************************************************/
+static bool readString(ifstream &fin, string &str)
+{
+    int len;
+    fin.read((char*)&len,sizeof(len));
+    if (!fin || (len<0) || (len>1024))
+        return false;
+
+    vector<char> buf(len+1,'\0');
+    fin.read(&buf[0],len);
+    str=&buf[0];
+    return !fin.fail();
+}
+
+
+/****************************************************************/
+static bool isTorsoMoving(const int conf)
+{
+    return ((conf!=configuration::no_torso_no_heave) &&
+            (conf!=configuration::no_torso_heave));
+}
+
+
+/****************************************************************/
+ReachabilityMap::ReachabilityMap() : torso_heave(0.0), lower_arm_heave(0.0),
+                                     full_pose(true), configuration(0),
+                                     ud(4,0.0), ang_tol(0.0), step(0.0)
+{
+    for (int i=0; i<3; i++)
+    {
+        origin[i]=0.0;
+        size[i]=0;
+    }
+}
+
+
+/****************************************************************/
+bool ReachabilityMap::configure(const string &arm_type,
+                                const string &orientation_class,
+                                const double torso_heave,
+                                const double lower_arm_heave,
+                                const bool full_pose,
+                                const int configuration,
+                                const Vector &ud, const double ang_tol,
+                                const Vector &x_min, const Vector &x_max,
+                                const double step)
+{
+    if ((ud.length()<4) || (x_min.length()<3) || (x_max.length()<3))
+    {
+        yError("mis-sized input vectors!");
+        return false;
+    }
+
+    if (step<=0.0)
+    {
+        yError("non-positive voxel side!");
+        return false;
+    }
+
+    for (int i=0; i<3; i++)
+    {
+        if (x_max[i]<=x_min[i])
+        {
+            yError("degenerate workspace box!");
+            return false;
+        }
+    }
+
+    // the workspace would depend on the torso pinned by the caller
+    if (!isTorsoMoving(configuration))
+    {
+        yError("maps cannot be built for configurations with no torso!");
+        return false;
+    }
+
+    this->arm_type=arm_type;
+    this->orientation_class=orientation_class;
+    this->torso_heave=torso_heave;
+    this->lower_arm_heave=lower_arm_heave;
+    this->full_pose=full_pose;
+    this->configuration=configuration;
+    this->ud=ud.subVector(0,3);
+    this->ang_tol=ang_tol;
+    this->step=step;
+
+    for (int i=0; i<3; i++)
+    {
+        origin[i]=x_min[i];
+        size[i]=std::max(1,(int)ceil((x_max[i]-x_min[i])/step));
+    }
+
+    voxels.assign(size[0]*size[1]*size[2],0);
+    nearest.assign(voxels.size(),-1);
+
+    return true;
+}
+
+
+/****************************************************************/
+Vector ReachabilityMap::getVoxelCenter(const int i) const
+{
+    int idx[3];
+    idx[2]=i%size[2];
+    idx[1]=(i/size[2])%size[1];
+    idx[0]=i/(size[1]*size[2]);
+
+    Vector x(3);
+    for (int j=0; j<3; j++)
+        x[j]=origin[j]+(idx[j]+0.5)*step;
+
+    return x;
+}
+
+
+/****************************************************************/
+void ReachabilityMap::setVoxel(const int i, const double manipulability)
+{
+    if ((i<0) || (i>=(int)voxels.size()))
+        return;
+
+    // reachable voxels hold at least 1
+    if (manipulability>0.0)
+        voxels[i]=(unsigned char)std::max(1.0,std::min(255.0,floor(255.0*manipulability+0.5)));
+    else
+        voxels[i]=0;
+}
+
+
+/****************************************************************/
+int ReachabilityMap::getIndex(const Vector &x, const bool clamp) const
+{
+    if (voxels.empty() || (x.length()<3))
+        return -1;
+
+    int idx[3];
+    for (int j=0; j<3; j++)
+    {
+        idx[j]=(int)floor((x[j]-origin[j])/step);
+        if ((idx[j]<0) || (idx[j]>=size[j]))
+        {
+            if (!clamp)
+                return -1;
+            idx[j]=std::max(0,std::min(size[j]-1,idx[j]));
+        }
+    }
+
+    return (idx[0]*size[1]+idx[1])*size[2]+idx[2];
+}
+
+
+/****************************************************************/
+void ReachabilityMap::computeNearest()
+{
+    // brushfire from the reachable voxels, where each voxel
+    // inherits the closest seed among those of its neighbors
+    nearest.assign(voxels.size(),-1);
+    deque<int> front;
+    for (size_t i=0; i<voxels.size(); i++)
+    {
+        if (voxels[i]>0)
+        {
+            nearest[i]=(int)i;
+            front.push_back((int)i);
+        }
+    }
+
+    const int stride[3]={size[1]*size[2],size[2],1};
+    while (!front.empty())
+    {
+        int i=front.front();
+        front.pop_front();
+
+        int idx[3]={i/stride[0],(i/stride[1])%size[1],i%size[2]};
+        Vector seed=getVoxelCenter(nearest[i]);
+
+        for (int j=0; j<3; j++)
+        {
+            for (int k=-1; k<=1; k+=2)
+            {
+                if ((idx[j]+k<0) || (idx[j]+k>=size[j]))
+                    continue;
+
+                int n=i+k*stride[j];
+                if (nearest[n]==nearest[i])
+                    continue;
+
+                Vector x=getVoxelCenter(n);
+                if ((nearest[n]<0) ||
+                    (norm(x-seed)<norm(x-getVoxelCenter(nearest[n]))))
+                {
+                    nearest[n]=nearest[i];
+                    front.push_back(n);
+                }
+            }
+        }
+    }
+}
+
+
+/****************************************************************/
+void ReachabilityMap::finalize()
+{
+    computeNearest();
+}
+
+
+/****************************************************************/
+bool ReachabilityMap::save(const string &file) const
+{
+    ofstream fout(file.c_str(),ios::out|ios::binary|ios::trunc);
+    if (!fout.is_open())
+    {
+        yError("unable to open \"%s\"!",file.c_str());
+        return false;
+    }
+
+    char fp=full_pose?1:0;
+    fout.write(REACHABILITY_MAGIC,8);
+    writeString(fout,arm_type);
+    writeString(fout,orientation_class);
+    fout.write((const char*)&torso_heave,sizeof(double));
+    fout.write((const char*)&lower_arm_heave,sizeof(double));
+    fout.write(&fp,1);
+    fout.write((const char*)&configuration,sizeof(int));
+    fout.write((const char*)ud.data(),4*sizeof(double));
+    fout.write((const char*)&ang_tol,sizeof(double));
+    fout.write((const char*)origin,3*sizeof(double));
+    fout.write((const char*)&step,sizeof(double));
+    fout.write((const char*)size,3*sizeof(int));
+    if (!voxels.empty())
+        fout.write((const char*)&voxels[0],voxels.size());
+
+    return !fout.fail();
+}
+
+
+/****************************************************************/
+bool ReachabilityMap::load(const string &file)
+{
+    ifstream fin(file.c_str(),ios::in|ios::binary);
+    if (!fin.is_open())
+    {
+        yError("unable to open \"%s\"!",file.c_str());
+        return false;
+    }
+
+    char magic[8];
+    fin.read(magic,sizeof(magic));
+    if (!fin || (string(magic,sizeof(magic))!=REACHABILITY_MAGIC))
+    {
+        yError("\"%s\" is not a reachability map!",file.c_str());
+        return false;
+    }
+
+    char fp;
+    ud.resize(4);
+    bool ok=readString(fin,arm_type);
+    ok&=readString(fin,orientation_class);
+    fin.read((char*)&torso_heave,sizeof(double));
+    fin.read((char*)&lower_arm_heave,sizeof(double));
+    fin.read(&fp,1);
+    fin.read((char*)&configuration,sizeof(int));
+    fin.read((char*)ud.data(),4*sizeof(double));
+    fin.read((char*)&ang_tol,sizeof(double));
+    fin.read((char*)origin,3*sizeof(double));
+    fin.read((char*)&step,sizeof(double));
+    fin.read((char*)size,3*sizeof(int));
+    full_pose=(fp!=0);
+
+    if (!ok || !fin || (step<=0.0) || (size[0]<=0) || (size[1]<=0) || (size[2]<=0))
+    {
+        yError("corrupted header in \"%s\"!",file.c_str());
+        voxels.clear();
+        nearest.clear();
+        return false;
+    }
+
+    voxels.resize(size[0]*size[1]*size[2]);
+    fin.read((char*)&voxels[0],voxels.size());
+    if (fin.fail())
+    {
+        yError("truncated map in \"%s\"!",file.c_str());
+        voxels.clear();
+        nearest.clear();
+        return false;
+    }
+
+    computeNearest();
+    return true;
+}
+
+
+/****************************************************************/
+bool ReachabilityMap::applies(const string &arm_type,
+                              const SolverParameters &params,
+                              const Matrix &Hd) const
+{
+    if (voxels.empty() || (arm_type!=this->arm_type) ||
+        (params.full_pose!=full_pose) || (params.configuration!=configuration) ||
+        !isTorsoMoving(configuration))
+        return false;
+
+    if ((fabs(params.torso_heave-torso_heave)>REACHABILITY_TOL_HEAVE) ||
+        (fabs(params.lower_arm_heave-lower_arm_heave)>REACHABILITY_TOL_HEAVE))
+        return false;
+
+    if (full_pose)
+    {
+        Vector e=dcm2axis(axis2dcm(ud)*Hd.transposed());
+        if (CTRL_RAD2DEG*fabs(e[3])>ang_tol)
+            return false;
+    }
+
+    return true;
+}
+
+
+/****************************************************************/
+double ReachabilityMap::getManipulability(const Vector &x) const
+{
+    int i=getIndex(x,false);
+    return (i>=0)?voxels[i]/255.0:0.0;
+}
+
+
+/****************************************************************/
+bool ReachabilityMap::isClearlyUnreachable(const Vector &x) const
+{
+    int i=getIndex(x,true);
+    if (i<0)
+        return false;
+
+    if (nearest[i]<0)
+        return true;
+
+    return (norm(x.subVector(0,2)-getVoxelCenter(nearest[i]))>sqrt(3.0)*step);
+}
+
+
+/****************************************************************/
+bool ReachabilityMap::getNearestReachable(const Vector &x,
+                                          Vector &x_nearest) const
+{
+    int i=getIndex(x,true);
+    if ((i<0) || (nearest[i]<0))
+        return false;
+
+    x_nearest=getVoxelCenter(nearest[i]);
+    return true;
+}
+
@@ -0,0 +1,334 @@
+/*
+ * Copyright (C) 2015 iCub Facility - Istituto Italiano di Tecnologia
+ * Author: Ugo Pattacini
+ * email:  ugo.pattacini@iit.it
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+#include <fstream>
+
+#include <yarp/os/Log.h>
+#include <yarp/os/LockGuard.h>
+#include <yarp/sig/Vector.h>
+#include <yarp/sig/Matrix.h>
+
+#include <cer_kinematics/seeds.h>
+
+// position, x axis, z axis and torso heave
+#define SEEDS_KEY_DIM       10
+#define SEEDS_MIN_PENDING   64
+#define SEEDS_MAGIC         "CERSEEDS"
+
+using namespace std;
+using namespace yarp::os;
+using namespace yarp::sig;
+using namespace cer::kinematics;
+
+
+/****************************************************************/
+namespace
+{
+    struct KeyComparator
+    {
+        const vector<double> &keys;
+        int axis;
+
+        /****************************************************************/
+        KeyComparator(const vector<double> &keys_, const int axis_) :
+                      keys(keys_), axis(axis_) { }
+
+        /****************************************************************/
+        bool operator()(const int i, const int j) const
+        {
+            return (keys[SEEDS_KEY_DIM*i+axis]<keys[SEEDS_KEY_DIM*j+axis]);
+        }
+    };
+}
+
+
+/****************************************************************/
+SeedLibrary::SeedLibrary(const double w_ang) : w_ang(w_ang)
+{
+}
+
+
+/****************************************************************/
+void SeedLibrary::computeKey(const Matrix &H, const double torso_heave,
+                             double *key) const
+{
+    for (int i=0; i<3; i++)
+    {
+        key[i]=H(i,3);
+        key[3+i]=w_ang*H(i,0);
+        key[6+i]=w_ang*H(i,2);
+    }
+    key[9]=torso_heave;
+}
+
+
+/****************************************************************/
+double SeedLibrary::squaredDistance(const double *key1,
+                                    const double *key2) const
+{
+    double d2=0.0;
+    for (int i=0; i<SEEDS_KEY_DIM; i++)
+    {
+        double d=key1[i]-key2[i];
+        d2+=d*d;
+    }
+    return d2;
+}
+
+
+/****************************************************************/
+void SeedLibrary::build(const int lo, const int hi, const int depth)
+{
+    if (hi<=lo)
+        return;
+
+    // median split along the axes in turn
+    int mid=(lo+hi)/2;
+    std::nth_element(tree.begin()+lo,tree.begin()+mid,tree.begin()+hi,
+                     KeyComparator(keys,depth%SEEDS_KEY_DIM));
+
+    build(lo,mid,depth+1);
+    build(mid+1,hi,depth+1);
+}
+
+
+/****************************************************************/
+void SeedLibrary::search(const int lo, const int hi, const int depth,
+                         const double *key, int &best, double &best_d2) const
+{
+    if (hi<=lo)
+        return;
+
+    int mid=(lo+hi)/2;
+    int idx=tree[mid];
+    double d2=squaredDistance(key,&keys[SEEDS_KEY_DIM*idx]);
+    if (d2<best_d2)
+    {
+        best=idx;
+        best_d2=d2;
+    }
+
+    int axis=depth%SEEDS_KEY_DIM;
+    double diff=key[axis]-keys[SEEDS_KEY_DIM*idx+axis];
+    if (diff<0.0)
+    {
+        search(lo,mid,depth+1,key,best,best_d2);
+        if (diff*diff<best_d2)
+            search(mid+1,hi,depth+1,key,best,best_d2);
+    }
+    else
+    {
+        search(mid+1,hi,depth+1,key,best,best_d2);
+        if (diff*diff<best_d2)
+            search(lo,mid,depth+1,key,best,best_d2);
+    }
+}
+
+
+/****************************************************************/
+void SeedLibrary::rebuild()
+{
+    tree.resize(seeds.size());
+    for (size_t i=0; i<tree.size(); i++)
+        tree[i]=(int)i;
+
+    build(0,(int)tree.size(),0);
+}
+
+
+/****************************************************************/
+void SeedLibrary::add(const Matrix &Hd, const double torso_heave,
+                      const Vector &q)
+{
+    if ((Hd.rows()!=4) || (Hd.cols()!=4))
+    {
+        yError("mis-sized target frame!");
+        return;
+    }
+
+    LockGuard lg(mutex);
+    if (!seeds.empty() && (q.length()!=seeds.front().length()))
+    {
+        yError("mis-sized DOFs vector!");
+        return;
+    }
+
+    double key[SEEDS_KEY_DIM];
+    computeKey(Hd,torso_heave,key);
+    keys.insert(keys.end(),key,key+SEEDS_KEY_DIM);
+    seeds.push_back(q);
+
+    // amortized rebuild of the tree
+    size_t pending=seeds.size()-tree.size();
+    if (pending>std::max((size_t)SEEDS_MIN_PENDING,tree.size()/4))
+        rebuild();
+}
+
+
+/****************************************************************/
+bool SeedLibrary::query(const Matrix &Hd, const double torso_heave,
+                        Vector &q, double &distance) const
+{
+    if ((Hd.rows()!=4) || (Hd.cols()!=4))
+    {
+        yError("mis-sized target frame!");
+        return false;
+    }
+
+    LockGuard lg(mutex);
+    if (seeds.empty())
+        return false;
+
+    double key[SEEDS_KEY_DIM];
+    computeKey(Hd,torso_heave,key);
+
+    int best=-1;
+    double best_d2=std::numeric_limits<double>::max();
+    search(0,(int)tree.size(),0,key,best,best_d2);
+
+    // the entries not yet indexed are scanned linearly
+    for (size_t i=tree.size(); i<seeds.size(); i++)
+    {
+        double d2=squaredDistance(key,&keys[SEEDS_KEY_DIM*i]);
+        if (d2<best_d2)
+        {
+            best=(int)i;
+            best_d2=d2;
+        }
+    }
+
+    q=seeds[best];
+    distance=sqrt(best_d2);
+    return true;
+}
+
+
+/****************************************************************/
+double SeedLibrary::distance(const Matrix &H1, const Matrix &H2) const
+{
+    double key1[SEEDS_KEY_DIM],key2[SEEDS_KEY_DIM];
+    computeKey(H1,0.0,key1);
+    computeKey(H2,0.0,key2);
+    return sqrt(squaredDistance(key1,key2));
+}
+
+
+/****************************************************************/
+size_t SeedLibrary::size() const
+{
+    LockGuard lg(mutex);
+    return seeds.size();
+}
+
+
+/****************************************************************/
+void SeedLibrary::clear()
+{
+    LockGuard lg(mutex);
+    keys.clear();
+    seeds.clear();
+    tree.clear();
+}
+
+
+/****************************************************************/
+bool SeedLibrary::save(const string &file) const
+{
+    ofstream fout(file.c_str(),ios::out|ios::binary|ios::trunc);
+    if (!fout.is_open())
+    {
+        yError("unable to open \"%s\"!",file.c_str());
+        return false;
+    }
+
+    LockGuard lg(mutex);
+    int n=(int)seeds.size();
+    int len=(n>0)?(int)seeds.front().length():0;
+
+    fout.write(SEEDS_MAGIC,8);
+    fout.write((const char*)&w_ang,sizeof(double));
+    fout.write((const char*)&n,sizeof(int));
+    fout.write((const char*)&len,sizeof(int));
+    if (n>0)
+    {
+        fout.write((const char*)&keys[0],keys.size()*sizeof(double));
+        for (int i=0; i<n; i++)
+            fout.write((const char*)seeds[i].data(),len*sizeof(double));
+    }
+
+    return !fout.fail();
+}
+
+
+/****************************************************************/
+bool SeedLibrary::load(const string &file)
+{
+    ifstream fin(file.c_str(),ios::in|ios::binary);
+    if (!fin.is_open())
+    {
+        yError("unable to open \"%s\"!",file.c_str());
+        return false;
+    }
+
+    char magic[8];
+    fin.read(magic,sizeof(magic));
+    if (!fin || (string(magic,sizeof(magic))!=SEEDS_MAGIC))
+    {
+        yError("\"%s\" is not a seed library!",file.c_str());
+        return false;
+    }
+
+    double w;
+    int n,len;
+    fin.read((char*)&w,sizeof(double));
+    fin.read((char*)&n,sizeof(int));
+    fin.read((char*)&len,sizeof(int));
+    if (!fin || (n<0) || (len<0))
+    {
+        yError("corrupted header in \"%s\"!",file.c_str());
+        return false;
+    }
+
+    vector<double> k(SEEDS_KEY_DIM*n);
+    vector<Vector> s(n,Vector(len));
+    if (n>0)
+    {
+        fin.read((char*)&k[0],k.size()*sizeof(double));
+        for (int i=0; i<n; i++)
+            fin.read((char*)s[i].data(),len*sizeof(double));
+    }
+
+    if (fin.fail())
+    {
+        yError("truncated library in \"%s\"!",file.c_str());
+        return false;
+    }
+
+    LockGuard lg(mutex);
+    w_ang=w;
+    keys.swap(k);
+    seeds.swap(s);
+    rebuild();
+
+    return true;
+}
+
@@ -17,7 +17,10 @@
 
 #include <algorithm>
 #include <cmath>
+#include <string>
+#include <vector>
 #include <deque>
+#include <fstream>
 
 #include <yarp/os/Log.h>
 #include <yarp/os/Time.h>
@@ -35,6 +38,10 @@
 #include <cer_kinematics/private/helpers.h>
 
 #define DELTA_RHO           1e-6
+#define NEWTON_MAX_ITER     20
+#define NEWTON_WEIGHT_Z     1e4
+#define NEWTON_TOL_Z        1e-4
+#define LUT_MAGIC           "CERTRLUT"
 
 using namespace std;
 using namespace yarp::os;
@@ -67,60 +74,14 @@ protected:
     /****************************************************************/
     TripodState fkin(const Ipopt::Number *x, TripodState *internal=NULL)
     {
-        double q33=sqrt(27.0)*params.r/sqrt(12.0*(x[2]*x[2]-(x[0]+x[1])*x[2]+
-                                            x[1]*x[1]-x[0]*x[1]+x[0]*x[0]+
-                                            (27.0/12.0)*params.r*params.r));
-
-        TripodState d;
-        if (q33>=1.0)
-        {
-            d.n=params.z;
-            d.u=0.0;
-            d.p[0]=d.p[1]=0.0;
-            d.p[2]=d.T(2,3)=x[0];
-        }
-        else
-        {
-            Vector v1=params.s[0]+x[0]*params.z;
-            Vector v2=params.s[1]+x[1]*params.z;
-            Vector v3=params.s[2]+x[2]*params.z;
-            d.n=cross(v2-v1,v3-v1);
-            d.n/=norm(d.n);
-
-            double sin_theta=sqrt(1.0-q33*q33);
-            d.u[0]=-d.n[1]/sin_theta;
-            d.u[1]=d.n[0]/sin_theta;
-            d.u[2]=0.0;
-            d.u[3]=acos(q33);
-            double tmp=(1.0-q33);
-            double q11=tmp*d.u[0]*d.u[0]+q33;
-            double q22=tmp*d.u[1]*d.u[1]+q33;
-            double q21=tmp*d.u[0]*d.u[1];
-            double q31=-sin_theta*d.u[1];
-            double q32=sin_theta*d.u[0];
-            double m1=params.r/q33*(-0.5*q11+1.5*q22);
-            d.p[0]=params.r-m1*q11;
-            d.p[1]=-m1*q21;
-            d.p[2]=x[0]-m1*q31;            
-
-            // transformation matrix
-            d.T(0,0)=q11; d.T(0,1)=q21; d.T(0,2)=-q31; d.T(0,3)=d.p[0];
-            d.T(1,0)=q21; d.T(1,1)=q22; d.T(1,2)=-q32; d.T(1,3)=d.p[1];
-            d.T(2,0)=q31; d.T(2,1)=q32; d.T(2,2)=q33;  d.T(2,3)=d.p[2];
-        }
-
+        TripodFrame d,din;
+        params.kernel.fkin(x,d,&din);
         if (internal!=NULL)
-            *internal=d;
-
-        d.n=params.R0*d.n;        
-        d.p=params.R0*d.p+params.p0;
-        d.T=params.T0*d.T;
-
-        double theta=d.u[3];
-        d.u=params.R0*d.u.subVector(0,2);
-        d.u.push_back(theta);
+            *internal=din;
 
-        return d;
+        TripodState state;
+        state=d;
+        return state;
     }
 
 public:
@@ -400,12 +361,50 @@ public:
 }
 
 
+/****************************************************************/
+static double det3x3(const double M[3][3])
+{
+    return M[0][0]*(M[1][1]*M[2][2]-M[1][2]*M[2][1])-
+           M[0][1]*(M[1][0]*M[2][2]-M[1][2]*M[2][0])+
+           M[0][2]*(M[1][0]*M[2][1]-M[1][1]*M[2][0]);
+}
+
+
+/****************************************************************/
+static bool solve3x3(const double M[3][3], const double b[3], double x[3])
+{
+    // Cramer's rule
+    double det=det3x3(M);
+    if (fabs(det)<1e-30)
+        return false;
+
+    for (int j=0; j<3; j++)
+    {
+        double Mj[3][3];
+        for (int i=0; i<3; i++)
+            for (int k=0; k<3; k++)
+                Mj[i][k]=(k==j)?b[i]:M[i][k];
+
+        x[j]=det3x3(Mj)/det;
+    }
+
+    return true;
+}
+
+
 /****************************************************************/
 TripodSolver::TripodSolver(const TripodParameters &params,
                            const int verb) :
                            Solver(verb),
-                           parameters(params)
+                           parameters(params),
+                           kernel(params),
+                           use_ipopt(false)
 {
+    for (int i=0; i<3; i++)
+    {
+        lut_origin[i]=lut_step[i]=0.0;
+        lut_size[i]=0;
+    }
 }
 
 
@@ -432,10 +431,20 @@ bool TripodSolver::fkin(const Vector &lll, Vector &p, Vector &u)
         return false;
     }
 
-    Ipopt::SmartPtr<TripodNLP> nlp=new TripodNLP(*this);
-    TripodState d=nlp->fkin(lll);
-    p=d.p;
-    u=d.u;
+    TripodFrame d;
+    kernel.fkin(lll.data(),d);
+
+    if (p.length()!=3)
+        p.resize(3);
+    if (u.length()!=4)
+        u.resize(4);
+
+    for (int i=0; i<3; i++)
+    {
+        p[i]=d.p[i];
+        u[i]=d.u[i];
+    }
+    u[3]=d.u[3];
 
     return true;
 }
@@ -450,14 +459,36 @@ bool TripodSolver::fkin(const Vector &lll, Vector &hpr)
         return false;
     }
 
-    Ipopt::SmartPtr<TripodNLP> nlp=new TripodNLP(*this);
-    TripodState d=nlp->fkin(lll);
+    TripodFrame d;
+    kernel.fkin(lll.data(),d);
+
+    // pitch and roll of the rotation given by (axis,angle)
+    double c=cos(d.u[3]);
+    double s=sin(d.u[3]);
+    double v=1.0-c;
+    double r20=v*d.u[2]*d.u[0]-s*d.u[1];
+    double r21=v*d.u[2]*d.u[1]+s*d.u[0];
+    double r22=v*d.u[2]*d.u[2]+c;
+
+    if (hpr.length()!=3)
+        hpr.resize(3);
 
-    Vector ypr=dcm2ypr(axis2dcm(d.u));
-    hpr.resize(3);
     hpr[0]=d.p[2];
-    hpr[1]=CTRL_RAD2DEG*ypr[1];
-    hpr[2]=CTRL_RAD2DEG*ypr[2];
+    if (r20>=1.0)
+    {
+        hpr[1]=-90.0;
+        hpr[2]=0.0;
+    }
+    else if (r20<=-1.0)
+    {
+        hpr[1]=90.0;
+        hpr[2]=0.0;
+    }
+    else
+    {
+        hpr[1]=CTRL_RAD2DEG*asin(-r20);
+        hpr[2]=CTRL_RAD2DEG*atan2(r21,r22);
+    }
 
     return true;
 }
@@ -472,9 +503,214 @@ bool TripodSolver::fkin(const Vector &q, Matrix &H, const int frame)
         return false;
     }
 
-    Ipopt::SmartPtr<TripodNLP> nlp=new TripodNLP(*this);
-    TripodState d=nlp->fkin(q);
-    H=d.T;
+    TripodFrame d;
+    kernel.fkin(q.data(),d);
+
+    if ((H.rows()!=4) || (H.cols()!=4))
+        H.resize(4,4);
+
+    for (int i=0; i<4; i++)
+        for (int j=0; j<4; j++)
+            H(i,j)=d.T[i][j];
+
+    return true;
+}
+
+
+/****************************************************************/
+void TripodSolver::getDesiredNormal(const Matrix &Rd, double *nd) const
+{
+    double zd[3]={Rd(0,2),Rd(1,2),Rd(2,2)};
+    getDesiredNormal(zd,nd);
+}
+
+
+/****************************************************************/
+void TripodSolver::getDesiredNormal(const double *zd, double *nd) const
+{
+    const Matrix &T0=parameters.T0;
+    double cos_alpha_max=cos(CTRL_DEG2RAD*parameters.alpha_max);
+
+    // desired normal to the platform in the tripod frame
+    for (int i=0; i<3; i++)
+        nd[i]=T0(0,i)*zd[0]+T0(1,i)*zd[1]+T0(2,i)*zd[2];
+
+    // projection within the cone of the permitted bending
+    if (nd[2]<cos_alpha_max)
+    {
+        double s=sqrt(nd[0]*nd[0]+nd[1]*nd[1]);
+        if (s>0.0)
+        {
+            double k=sin(CTRL_DEG2RAD*parameters.alpha_max)/s;
+            nd[0]*=k; nd[1]*=k;
+            nd[2]=cos_alpha_max;
+        }
+        else
+        {
+            nd[0]=nd[1]=0.0;
+            nd[2]=1.0;
+        }
+    }
+}
+
+
+/****************************************************************/
+bool TripodSolver::solveNewton(const double zd, const Vector &ud,
+                               Vector &lll) const
+{
+    const double &r=parameters.r;
+    const double &l_min=parameters.l_min;
+    const double &l_max=parameters.l_max;
+    double cos_alpha_max=cos(CTRL_DEG2RAD*parameters.alpha_max);
+
+    double nd[3];
+    getDesiredNormal(axis2dcm(ud),nd);
+
+    // closed form: the plane through the three joints is normal
+    // to nd and holds the platform center at the heave zd
+    double w=1.0/(1.0+nd[2]);
+    double c=-0.5*(1.0-nd[0]*nd[0]*w)+1.5*(1.0-nd[1]*nd[1]*w);
+    double x[3];
+    x[0]=zd-r/nd[2]*c*nd[0];
+
+    double theta=0.0;
+    for (int i=1; i<3; i++)
+    {
+        theta+=2.0*M_PI/3.0;
+        x[i]=x[0]-(nd[0]*(r*cos(theta)-r)+nd[1]*r*sin(theta))/nd[2];
+    }
+
+    bool inside=true;
+    for (int i=0; i<3; i++)
+        inside&=((x[i]>=l_min) && (x[i]<=l_max));
+
+    if (!inside)
+    {
+        // bounded Gauss-Newton on [zd-p_z; nd_x-n_x; nd_y-n_y],
+        // where the heave is given the priority by weighting
+        const double W[3]={NEWTON_WEIGHT_Z,1.0,1.0};
+        for (int i=0; i<3; i++)
+            x[i]=std::max(l_min,std::min(l_max,x[i]));
+
+        for (int iter=0; iter<NEWTON_MAX_ITER; iter++)
+        {
+            TripodFrame d,din;
+            TripodJacobian J,Jin;
+            kernel.fkin(x,d,&din);
+            kernel.jacobian(x,J,&Jin);
+
+            double res[3]={zd-din.p[2],nd[0]-din.n[0],nd[1]-din.n[1]};
+            double merit=W[0]*res[0]*res[0]+W[1]*res[1]*res[1]+W[2]*res[2]*res[2];
+
+            double A[3][3];
+            for (int k=0; k<3; k++)
+            {
+                A[0][k]=Jin.dp[k][2];
+                A[1][k]=Jin.dn[k][0];
+                A[2][k]=Jin.dn[k][1];
+            }
+
+            // normal equations, holding the elongations that lie
+            // on a bound and are pushed outward
+            double M[3][3],g[3];
+            bool held[3];
+            for (int i=0; i<3; i++)
+            {
+                g[i]=0.0;
+                for (int k=0; k<3; k++)
+                    g[i]+=A[k][i]*W[k]*res[k];
+
+                held[i]=((x[i]<=l_min) && (g[i]<0.0)) ||
+                        ((x[i]>=l_max) && (g[i]>0.0));
+            }
+
+            for (int i=0; i<3; i++)
+            {
+                for (int j=0; j<3; j++)
+                {
+                    M[i][j]=0.0;
+                    if (held[i] || held[j])
+                        continue;
+
+                    for (int k=0; k<3; k++)
+                        M[i][j]+=A[k][i]*W[k]*A[k][j];
+                }
+
+                if (held[i])
+                {
+                    M[i][i]=1.0;
+                    g[i]=0.0;
+                }
+                else
+                    M[i][i]+=1e-9;
+            }
+
+            double dx[3];
+            if (!solve3x3(M,g,dx))
+                break;
+
+            // backtracking along the projected path
+            bool descent=false;
+            double step=0.0;
+            for (double t=1.0; t>1e-4; t*=0.5)
+            {
+                double xn[3];
+                for (int i=0; i<3; i++)
+                    xn[i]=std::max(l_min,std::min(l_max,x[i]+t*dx[i]));
+                kernel.fkin(xn,d,&din);
+
+                double rn[3]={zd-din.p[2],nd[0]-din.n[0],nd[1]-din.n[1]};
+                if (W[0]*rn[0]*rn[0]+W[1]*rn[1]*rn[1]+W[2]*rn[2]*rn[2]<merit)
+                {
+                    for (int i=0; i<3; i++)
+                    {
+                        step=std::max(step,fabs(xn[i]-x[i]));
+                        x[i]=xn[i];
+                    }
+                    descent=true;
+                    break;
+                }
+            }
+
+            if (!descent || (step<1e-9))
+                break;
+        }
+
+        // shrink the elongations toward their mean, which preserves
+        // the bounds, until the bending is back within the cone
+        TripodFrame d,din;
+        kernel.fkin(x,d,&din);
+        if (din.n[2]<cos_alpha_max)
+        {
+            double mean=(x[0]+x[1]+x[2])/3.0;
+            double x0[3]={x[0],x[1],x[2]};
+            double lo=0.0,hi=1.0;
+            for (int iter=0; iter<30; iter++)
+            {
+                double s=0.5*(lo+hi);
+                for (int i=0; i<3; i++)
+                    x[i]=mean+s*(x0[i]-mean);
+                kernel.fkin(x,d,&din);
+
+                if (din.n[2]<cos_alpha_max)
+                    hi=s;
+                else
+                    lo=s;
+            }
+
+            for (int i=0; i<3; i++)
+                x[i]=mean+lo*(x0[i]-mean);
+        }
+
+        kernel.fkin(x,d,&din);
+        if (fabs(zd-din.p[2])>NEWTON_TOL_Z)
+            return false;
+    }
+
+    if (lll.length()!=3)
+        lll.resize(3);
+    for (int i=0; i<3; i++)
+        lll[i]=x[i];
 
     return true;
 }
@@ -493,36 +729,48 @@ bool TripodSolver::ikin(const double zd, const Vector &ud,
 
     int print_level=std::max(verbosity-5,0);
 
-    Ipopt::SmartPtr<Ipopt::IpoptApplication> app=new Ipopt::IpoptApplication;
-    app->Options()->SetNumericValue("tol",1e-6);
-    app->Options()->SetNumericValue("constr_viol_tol",1e-8);
-    app->Options()->SetIntegerValue("acceptable_iter",0);
-    app->Options()->SetStringValue("mu_strategy","adaptive");
-    app->Options()->SetIntegerValue("max_iter",200);
-    app->Options()->SetStringValue("nlp_scaling_method","gradient-based");
-    app->Options()->SetNumericValue("nlp_scaling_max_gradient",1.0);
-    app->Options()->SetNumericValue("nlp_scaling_min_value",1e-6);
-    app->Options()->SetStringValue("hessian_approximation","limited-memory");
-    app->Options()->SetStringValue("derivative_test",print_level>=4?"first-order":"none");
-    app->Options()->SetIntegerValue("print_level",print_level);
-    app->Initialize();
-
-    Ipopt::SmartPtr<TripodNLP> nlp=new TripodNLP(*this);    
-    nlp->set_rho0(lll0);
-    nlp->set_zd(zd);
-    nlp->set_ud(ud);
-    
     double t0=Time::now();
-    Ipopt::ApplicationReturnStatus status=app->OptimizeTNLP(GetRawPtr(nlp));
-    double t1=Time::now();    
+    string method="newton";
+    Ipopt::ApplicationReturnStatus status=Ipopt::Solve_Succeeded;
+    if (use_ipopt || !solveNewton(zd,ud,lll))
+    {
+        Ipopt::SmartPtr<Ipopt::IpoptApplication> app=new Ipopt::IpoptApplication;
+        app->Options()->SetNumericValue("tol",1e-6);
+        app->Options()->SetNumericValue("constr_viol_tol",1e-8);
+        app->Options()->SetIntegerValue("acceptable_iter",0);
+        app->Options()->SetStringValue("mu_strategy","adaptive");
+        app->Options()->SetIntegerValue("max_iter",200);
+        app->Options()->SetStringValue("nlp_scaling_method","gradient-based");
+        app->Options()->SetNumericValue("nlp_scaling_max_gradient",1.0);
+        app->Options()->SetNumericValue("nlp_scaling_min_value",1e-6);
+        app->Options()->SetStringValue("hessian_approximation","limited-memory");
+        app->Options()->SetStringValue("derivative_test",print_level>=4?"first-order":"none");
+        app->Options()->SetIntegerValue("print_level",print_level);
+        app->Initialize();
+
+        Ipopt::SmartPtr<TripodNLP> nlp=new TripodNLP(*this);
+        nlp->set_rho0(lll0);
+        nlp->set_zd(zd);
+        nlp->set_ud(ud);
+
+        method="ipopt";
+        {
+            LinearSolverLock lsl(*app);
+            status=app->OptimizeTNLP(GetRawPtr(nlp));
+        }
+        lll=nlp->get_result();
+    }
+    double t1=Time::now();
 
-    lll=nlp->get_result();
     if (exit_code!=NULL)
         *exit_code=status;
 
     if (verbosity>0)
     {
-        TripodState d=nlp->fkin(lll);
+        TripodFrame dd;
+        kernel.fkin(lll.data(),dd);
+        TripodState d;
+        d=dd;
 
         Vector e_u=dcm2axis(axis2dcm(ud)*d.T.transposed());
         e_u*=e_u[3]; e_u.pop_back();
@@ -537,6 +785,7 @@ bool TripodSolver::ikin(const double zd, const Vector &ud,
         yInfo(" *** Tripod Solver:   e_u [rad] = %g",norm(e_u));
         yInfo(" *** Tripod Solver:     e_z [m] = %g",fabs(zd-d.p[2]));
         yInfo(" *** Tripod Solver: alpha [deg] = %g",CTRL_RAD2DEG*acos(d.n[2]));
+        yInfo(" *** Tripod Solver:      method = %s",method.c_str());
         yInfo(" *** Tripod Solver:     dt [ms] = %g",1000.0*(t1-t0));
         yInfo(" *** Tripod Solver ******************************");
     }
@@ -562,6 +811,217 @@ bool TripodSolver::ikin(const double zd, const Vector &ud,
 }
 
 
+/****************************************************************/
+bool TripodSolver::loadLUT(const string &cache, const vector<double> &header,
+                           vector<double> &table) const
+{
+    ifstream fin(cache.c_str(),ios::in|ios::binary);
+    if (!fin.is_open())
+        return false;
+
+    char magic[8];
+    fin.read(magic,sizeof(magic));
+    if (!fin || (string(magic,sizeof(magic))!=LUT_MAGIC))
+        return false;
+
+    vector<double> h(header.size());
+    fin.read((char*)&h[0],h.size()*sizeof(double));
+    if (!fin || (h!=header))
+        return false;
+
+    fin.read((char*)&table[0],table.size()*sizeof(double));
+    return !fin.fail();
+}
+
+
+/****************************************************************/
+bool TripodSolver::saveLUT(const string &cache, const vector<double> &header,
+                           const vector<double> &table) const
+{
+    ofstream fout(cache.c_str(),ios::out|ios::binary|ios::trunc);
+    if (!fout.is_open())
+        return false;
+
+    fout.write(LUT_MAGIC,8);
+    fout.write((const char*)&header[0],header.size()*sizeof(double));
+    fout.write((const char*)&table[0],table.size()*sizeof(double));
+    return !fout.fail();
+}
+
+
+/****************************************************************/
+bool TripodSolver::enableLUT(const double step_heave, const double step_angle,
+                             const string &cache)
+{
+    if ((step_heave<=0.0) || (step_angle<=0.0))
+    {
+        yError("non-positive LUT steps!");
+        return false;
+    }
+
+    // the steps are adjusted to span the ranges exactly
+    double origin[3]={parameters.l_min,-parameters.alpha_max,-parameters.alpha_max};
+    double range[3]={parameters.l_max-parameters.l_min,
+                     2.0*parameters.alpha_max,2.0*parameters.alpha_max};
+    double step[3]={step_heave,step_angle,step_angle};
+    int size[3];
+    for (int i=0; i<3; i++)
+    {
+        if (range[i]<=0.0)
+        {
+            yError("degenerate tripod ranges!");
+            return false;
+        }
+
+        size[i]=std::max(2,(int)ceil(range[i]/step[i])+1);
+        step[i]=range[i]/(size[i]-1);
+    }
+
+    // what the cached table must agree with
+    vector<double> header;
+    header.push_back(parameters.r);
+    header.push_back(parameters.l_min);
+    header.push_back(parameters.l_max);
+    header.push_back(parameters.alpha_max);
+    for (int i=0; i<4; i++)
+        for (int j=0; j<4; j++)
+            header.push_back(parameters.T0(i,j));
+    for (int i=0; i<3; i++)
+        header.push_back(size[i]);
+
+    vector<double> table(3*size[0]*size[1]*size[2]);
+    if (!cache.empty() && loadLUT(cache,header,table))
+    {
+        if (verbosity>0)
+            yInfo(" *** Tripod Solver: LUT loaded from \"%s\"",cache.c_str());
+    }
+    else
+    {
+        double t0=Time::now();
+        Vector hpr(3),ypr(3,0.0),lll(3);
+        for (int i=0; i<size[0]; i++)
+        {
+            hpr[0]=origin[0]+i*step[0];
+            for (int j=0; j<size[1]; j++)
+            {
+                hpr[1]=origin[1]+j*step[1];
+                for (int k=0; k<size[2]; k++)
+                {
+                    hpr[2]=origin[2]+k*step[2];
+                    ypr[1]=CTRL_DEG2RAD*hpr[1];
+                    ypr[2]=CTRL_DEG2RAD*hpr[2];
+
+                    Vector ud=dcm2axis(ypr2dcm(ypr));
+                    if (!solveNewton(hpr[0],ud,lll))
+                        ikin(hpr[0],ud,lll);
+
+                    double *node=&table[3*((i*size[1]+j)*size[2]+k)];
+                    node[0]=lll[0]; node[1]=lll[1]; node[2]=lll[2];
+                }
+            }
+        }
+
+        if (verbosity>0)
+            yInfo(" *** Tripod Solver: LUT of %d nodes built in %g [s]",
+                  size[0]*size[1]*size[2],Time::now()-t0);
+
+        if (!cache.empty() && !saveLUT(cache,header,table))
+            yWarning("unable to store the LUT in \"%s\"!",cache.c_str());
+    }
+
+    LockGuard lg(makeThreadSafe);
+    lut.swap(table);
+    for (int i=0; i<3; i++)
+    {
+        lut_origin[i]=origin[i];
+        lut_step[i]=step[i];
+        lut_size[i]=size[i];
+    }
+
+    return true;
+}
+
+
+/****************************************************************/
+void TripodSolver::disableLUT()
+{
+    LockGuard lg(makeThreadSafe);
+    lut.clear();
+}
+
+
+/****************************************************************/
+bool TripodSolver::lookupLUT(const Vector &hpr, Vector &lll)
+{
+    LockGuard lg(makeThreadSafe);
+    if (lut.empty())
+        return false;
+
+    int i0[3];
+    double f[3];
+    for (int i=0; i<3; i++)
+    {
+        double c=(hpr[i]-lut_origin[i])/lut_step[i];
+        if ((c<0.0) || (c>lut_size[i]-1))
+            return false;
+
+        i0[i]=std::min((int)c,lut_size[i]-2);
+        f[i]=c-i0[i];
+    }
+
+    // trilinear interpolation
+    double x[3]={0.0,0.0,0.0};
+    for (int c=0; c<8; c++)
+    {
+        int di=(c>>2)&1,dj=(c>>1)&1,dk=c&1;
+        double w=(di?f[0]:1.0-f[0])*(dj?f[1]:1.0-f[1])*(dk?f[2]:1.0-f[2]);
+        const double *node=&lut[3*(((i0[0]+di)*lut_size[1]+i0[1]+dj)*lut_size[2]+i0[2]+dk)];
+        for (int i=0; i<3; i++)
+            x[i]+=w*node[i];
+    }
+
+    // one Newton refinement on [zd-p_z; nd_x-n_x; nd_y-n_y], where
+    // the z-axis of ypr2dcm([0 pitch roll]) is computed in place
+    double pitch=CTRL_DEG2RAD*hpr[1];
+    double roll=CTRL_DEG2RAD*hpr[2];
+    double zd[3]={sin(pitch)*cos(roll),-sin(roll),cos(pitch)*cos(roll)};
+    double nd[3];
+    getDesiredNormal(zd,nd);
+
+    TripodFrame d,din;
+    TripodJacobian J,Jin;
+    kernel.fkin(x,d,&din);
+    kernel.jacobian(x,J,&Jin);
+
+    double res[3]={hpr[0]-din.p[2],nd[0]-din.n[0],nd[1]-din.n[1]};
+    double A[3][3],dx[3];
+    for (int k=0; k<3; k++)
+    {
+        A[0][k]=Jin.dp[k][2];
+        A[1][k]=Jin.dn[k][0];
+        A[2][k]=Jin.dn[k][1];
+    }
+
+    if (solve3x3(A,res,dx))
+        for (int i=0; i<3; i++)
+            x[i]=std::max(parameters.l_min,std::min(parameters.l_max,x[i]+dx[i]));
+
+    // the interpolation is not guaranteed to comply with the heave
+    // and the bending limit, in which case the regular path is taken
+    kernel.fkin(x,d,&din);
+    if ((fabs(hpr[0]-din.p[2])>NEWTON_TOL_Z) ||
+        (din.n[2]<cos(CTRL_DEG2RAD*parameters.alpha_max)))
+        return false;
+
+    if (lll.length()!=3)
+        lll.resize(3);
+    for (int i=0; i<3; i++)
+        lll[i]=x[i];
+
+    return true;
+}
+
+
 /****************************************************************/
 bool TripodSolver::ikin(const Vector &hpr, Vector &lll,
                         int *exit_code)
@@ -572,6 +1032,13 @@ bool TripodSolver::ikin(const Vector &hpr, Vector &lll,
         return false;
     }
 
+    if (lookupLUT(hpr,lll))
+    {
+        if (exit_code!=NULL)
+            *exit_code=Ipopt::Solve_Succeeded;
+        return true;
+    }
+
     Vector ypr(3,0.0);
     ypr[1]=CTRL_DEG2RAD*hpr[1];
     ypr[2]=CTRL_DEG2RAD*hpr[2];
@@ -21,6 +21,7 @@
 #include <iCub/ctrl/math.h>
 
 #include <cer_kinematics/utils.h>
+#include <cer_kinematics/private/helpers.h>
 
 using namespace std;
 using namespace yarp::sig;
@@ -32,7 +33,7 @@ using namespace cer::kinematics;
 namespace cer {
 namespace kinematics {
 
-yarp::os::Mutex Solver::makeThreadSafe;
+yarp::os::Mutex LinearSolverLock::mutex;
 
 /****************************************************************/
 bool stepModeParser(string &mode, string &submode)
@@ -261,7 +262,7 @@ bool SolverParameters::setMode(const string &mode)
                 tol=1e-5;
                 constr_tol=1e-4;
             }
-            if (submode=="heave")
+            else if (submode=="heave")
                 configuration=configuration::heave;
             else if (submode=="no_heave")
                 configuration=configuration::no_heave;
@@ -270,9 +271,20 @@ bool SolverParameters::setMode(const string &mode)
             else if (submode=="no_torso_no_heave")
                 configuration=configuration::no_torso_no_heave;
             else if (submode=="forward_diff")
-                use_central_difference=false;                
+            {
+                use_central_difference=false;
+                use_analytic_derivatives=false;
+            }
             else if (submode=="central_diff")
+            {
                 use_central_difference=true;
+                use_analytic_derivatives=false;
+            }
+            else if (submode=="analytic_diff")
+            {
+                use_central_difference=false;
+                use_analytic_derivatives=true;
+            }
             else
                 ret=false;
         }
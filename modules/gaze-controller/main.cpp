@@ -56,6 +56,7 @@ class Controller : public RFModule, public PortReader
     VectorOf<int> curMode;
 
     map<string,HeadSolver> solver;
+    map<string,Matrix> Hframes;
     map<string,Matrix> intrinsincs;
     minJerkTrajGen* gen;
     
@@ -360,6 +361,21 @@ class Controller : public RFModule, public PortReader
 
             s.setHeadParameters(p);
         }
+
+        alignBranches();
+    }
+
+    /****************************************************************/
+    void alignBranches()
+    {
+        // fkinAll() branches to all the types, which must
+        // then share the bounds of the respective solvers
+        for (map<string,HeadSolver>::iterator it=solver.begin();
+             it!=solver.end(); it++)
+            for (map<string,HeadSolver>::iterator jt=solver.begin();
+                 jt!=solver.end(); jt++)
+                if (jt!=it)
+                    it->second.setBranchParameters(jt->second.getHeadParameters());
     }
 
     /****************************************************************/
@@ -447,18 +463,21 @@ class Controller : public RFModule, public PortReader
 
             s.setHeadParameters(p);
         }
+
+        alignBranches();
     }
 
     /****************************************************************/
     void fillState(const Vector &q, Property &state)
     {
         state.clear();
+
+        // all the frames stem from one pass over torso and neck
+        solver[control_frame].fkinAll(q,Hframes);
         for (set<string>::iterator it=avFrames.begin(); it!=avFrames.end(); it++)
         {
             const string &frame=*it;
-
-            Matrix Hee;
-            solver[frame].fkin(q,Hee);
+            const Matrix &Hee=Hframes[frame];
 
             Vector pose=Hee.getCol(3).subVector(0,2);
             Vector oee; oee=dcm2axis(Hee);
@@ -16,6 +16,7 @@
 */
 
 #include <string>
+#include <deque>
 #include <cmath>
 #include <algorithm>
 
@@ -36,12 +37,179 @@ using namespace iCub::iKin;
 using namespace cer::kinematics;
 
 
+/****************************************************************/
+class TargetCache
+{
+    struct Entry
+    {
+        Matrix Hd;
+        double torso_heave;
+        double lower_arm_heave;
+        int mode;
+        Vector q;
+    };
+
+    deque<Entry> entries;
+    unsigned int hits,warm_starts,misses;
+
+    /****************************************************************/
+    bool match(const Entry &entry, const Matrix &Hd, const SolverParameters &p,
+               const Vector &q, const double scale) const
+    {
+        if (entry.mode!=getMode(p))
+            return false;
+
+        if ((fabs(entry.torso_heave-p.torso_heave)>scale*tol_heave) ||
+            (fabs(entry.lower_arm_heave-p.lower_arm_heave)>scale*tol_heave))
+            return false;
+
+        // when not optimized, the torso is held at the request's
+        // configuration, which is then part of the key
+        if (!isTorsoMoving(p))
+        {
+            for (int i=0; i<3; i++)
+                if (fabs(entry.q[i]-q[i])>scale*tol_heave)
+                    return false;
+
+            if (fabs(entry.q[3]-q[3])>scale*tol_ang)
+                return false;
+        }
+
+        if (norm(entry.Hd.getCol(3).subVector(0,2)-Hd.getCol(3).subVector(0,2))>scale*tol_pos)
+            return false;
+
+        // the orientation matters only in full_pose mode
+        if (p.full_pose)
+        {
+            Vector e=dcm2axis(entry.Hd*Hd.transposed());
+            if ((180.0/M_PI)*fabs(e[3])>scale*tol_ang)
+                return false;
+        }
+
+        return true;
+    }
+
+public:
+    int size;
+    double tol_pos,tol_ang,tol_heave;
+    double warm_factor;
+
+    /****************************************************************/
+    TargetCache() : hits(0), warm_starts(0), misses(0), size(16),
+                    tol_pos(0.001), tol_ang(0.5), tol_heave(0.001),
+                    warm_factor(10.0) { }
+
+    /****************************************************************/
+    static int getMode(const SolverParameters &p)
+    {
+        return ((p.full_pose?0x01:0x00)|(p.configuration<<1));
+    }
+
+    /****************************************************************/
+    static bool isTorsoMoving(const SolverParameters &p)
+    {
+        return ((p.configuration!=configuration::no_torso_no_heave) &&
+                (p.configuration!=configuration::no_torso_heave));
+    }
+
+    /****************************************************************/
+    bool lookup(const Matrix &Hd, const SolverParameters &p, const Vector &q0,
+                Vector &q, bool &warm)
+    {
+        // entries within the tolerances are reused as they are,
+        // while near misses can still seed the solver
+        warm=false;
+        for (size_t i=0; i<entries.size(); i++)
+        {
+            if (match(entries[i],Hd,p,q0,1.0))
+            {
+                q=entries[i].q;
+                hits++;
+                return true;
+            }
+        }
+
+        for (size_t i=0; i<entries.size(); i++)
+        {
+            if (match(entries[i],Hd,p,q0,warm_factor))
+            {
+                // a pinned torso must stay where it is requested
+                q=entries[i].q;
+                if (!isTorsoMoving(p))
+                    for (int j=0; j<4; j++)
+                        q[j]=q0[j];
+
+                warm=true;
+                break;
+            }
+        }
+
+        if (warm)
+            warm_starts++;
+        else
+            misses++;
+        return false;
+    }
+
+    /****************************************************************/
+    void store(const Matrix &Hd, const SolverParameters &p, const Vector &q)
+    {
+        if (size<=0)
+            return;
+
+        Entry entry;
+        entry.Hd=Hd;
+        entry.torso_heave=p.torso_heave;
+        entry.lower_arm_heave=p.lower_arm_heave;
+        entry.mode=getMode(p);
+        entry.q=q;
+
+        entries.push_front(entry);
+        while (entries.size()>(size_t)size)
+            entries.pop_back();
+    }
+
+    /****************************************************************/
+    void clear()
+    {
+        entries.clear();
+    }
+
+    /****************************************************************/
+    void getStats(Bottle &stats) const
+    {
+        unsigned int requests=hits+warm_starts+misses;
+
+        Bottle &h=stats.addList();
+        h.addString("hits");
+        h.addInt(hits);
+
+        Bottle &w=stats.addList();
+        w.addString("warm_starts");
+        w.addInt(warm_starts);
+
+        Bottle &m=stats.addList();
+        m.addString("misses");
+        m.addInt(misses);
+
+        Bottle &r=stats.addList();
+        r.addString("hit_rate");
+        r.addDouble(requests>0?(double)hits/requests:0.0);
+    }
+};
+
+
 /****************************************************************/
 class IKSolver : public RFModule
 {    
     ArmSolver solver;
     RpcServer rpcPort;
     Vector q;
+    int multi_start;
+    TargetCache cache;
+    SeedLibrary seeds;
+    string seeds_file;
+    bool seeds_learn;
 
     /****************************************************************/
     bool getBounds(const string &remote, const string &local,
@@ -138,6 +306,12 @@ public:
         string arm_type=rf.check("arm-type",Value("left")).asString();
         bool get_bounds=(rf.check("get-bounds",Value("on")).asString()=="on");
         int verbosity=rf.check("verbosity",Value(0)).asInt();
+        multi_start=std::max(rf.check("multi-start",Value(1)).asInt(),1);
+        cache.size=rf.check("cache-size",Value(cache.size)).asInt();
+        cache.tol_pos=rf.check("cache-tol-pos",Value(cache.tol_pos)).asDouble();
+        cache.tol_ang=rf.check("cache-tol-ang",Value(cache.tol_ang)).asDouble();
+        cache.tol_heave=rf.check("cache-tol-heave",Value(cache.tol_heave)).asDouble();
+        cache.warm_factor=rf.check("cache-warm-factor",Value(cache.warm_factor)).asDouble();
 
         SolverParameters p=solver.getSolverParameters();
         p.setMode("full_pose");
@@ -153,6 +327,31 @@ public:
             if (!alignJointsBounds(robot,arm_type))
                 return false;
 
+        // maps of the workspace to screen the targets
+        if (Bottle *maps=rf.find("reachability-maps").asList())
+        {
+            for (int i=0; i<maps->size(); i++)
+            {
+                ReachabilityMap map;
+                if (!map.load(maps->get(i).asString()))
+                    return false;
+                solver.addReachabilityMap(map);
+            }
+            solver.setReachabilityClamping(rf.check("reachability-clamp"));
+        }
+
+        // solved targets to draw the initial guesses from
+        if (rf.check("seed-library"))
+        {
+            seeds_file=rf.find("seed-library").asString();
+            seeds_learn=rf.check("seed-learn");
+            if (!seeds.load(seeds_file) && !seeds_learn)
+                return false;
+            solver.enableSeedLibrary(seeds,seeds_learn);
+        }
+        else
+            seeds_learn=false;
+
         q.resize(3+solver.getArmParameters().upper_arm.getDOF()+3,0.0);
         rpcPort.open(("/cer_reaching-solver/"+arm_type+"/rpc").c_str());
         attach(rpcPort);
@@ -164,6 +363,8 @@ public:
     bool close()
     {
         rpcPort.close();
+        if (seeds_learn)
+            seeds.save(seeds_file);
         return true;
     }
 
@@ -209,8 +410,46 @@ public:
                     ack=true;
                 }
 
+                if (parameters->check("multi_start"))
+                {
+                    multi_start=std::max(parameters->find("multi_start").asInt(),1);
+                    ack=true;
+                }
+
+                if (parameters->check("cache_size"))
+                {
+                    cache.size=parameters->find("cache_size").asInt();
+                    ack=true;
+                }
+
+                if (parameters->check("cache_tol_pos"))
+                {
+                    cache.tol_pos=parameters->find("cache_tol_pos").asDouble();
+                    ack=true;
+                }
+
+                if (parameters->check("cache_tol_ang"))
+                {
+                    cache.tol_ang=parameters->find("cache_tol_ang").asDouble();
+                    ack=true;
+                }
+
+                if (parameters->check("cache_tol_heave"))
+                {
+                    cache.tol_heave=parameters->find("cache_tol_heave").asDouble();
+                    ack=true;
+                }
+
+                if (parameters->check("cache_warm_factor"))
+                {
+                    cache.warm_factor=parameters->find("cache_warm_factor").asDouble();
+                    ack=true;
+                }
+
                 if (ack)
                 {
+                    // cached solutions refer to the former parameters
+                    cache.clear();
                     solver.setSolverParameters(p);
                     reply.clear();
                     reply.addVocab(Vocab::encode("ack"));
@@ -218,6 +457,47 @@ public:
             }
         }
 
+        if (cmd.check("cache_stats"))
+        {
+            reply.clear();
+            reply.addVocab(Vocab::encode("ack"));
+            cache.getStats(reply);
+        }
+
+        if (cmd.check("solver_stats"))
+        {
+            reply.clear();
+            reply.addVocab(Vocab::encode("ack"));
+
+            const double percentiles[]={50.0,90.0,99.0};
+            for (int i=0; i<3; i++)
+            {
+                ArmSolverStats stats;
+                if (!solver.getStatsPercentile(percentiles[i],stats))
+                    break;
+
+                Bottle &b=reply.addList();
+                b.addString("percentile");
+                b.addDouble(percentiles[i]);
+
+                Bottle &t=b.addList();
+                t.addString("total_time");
+                t.addDouble(stats.total_time);
+
+                Bottle &l=b.addList();
+                l.addString("ipopt_time");
+                l.addDouble(stats.ipopt_time);
+
+                Bottle &it=b.addList();
+                it.addString("iterations");
+                it.addInt(stats.iterations);
+
+                Bottle &v=b.addList();
+                v.addString("constraint_violation");
+                v.addDouble(stats.constraint_violation);
+            }
+        }
+
         if (Bottle *payLoad=cmd.find("q").asList())
         {
             int len=std::min(payLoad->size(),(int)q.length());
@@ -254,8 +534,24 @@ public:
             Hd.setSubcol(xd,0,3);
 
             solver.setSolverParameters(p);
-            solver.setInitialGuess(q);
-            solver.ikin(Hd,q);
+
+            bool warm;
+            Vector q_cached;
+            if (cache.lookup(Hd,p,q,q_cached,warm))
+                q=q_cached;
+            else
+            {
+                solver.setInitialGuess(warm?q_cached:q);
+
+                bool ok;
+                if (multi_start>1)
+                    ok=solver.ikinMultiStart(Hd,q,multi_start);
+                else
+                    ok=solver.ikin(Hd,q);
+
+                if (ok)
+                    cache.store(Hd,p,q);
+            }
 
             reply.clear();
             reply.addVocab(Vocab::encode("ack"));
@@ -0,0 +1,389 @@
+/*
+ * Copyright (C) 2015 iCub Facility - Istituto Italiano di Tecnologia
+ * Author: Ugo Pattacini
+ * email:  ugo.pattacini@iit.it
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+*/
+
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include <yarp/os/all.h>
+#include <yarp/sig/all.h>
+#include <yarp/math/Math.h>
+
+#include <iCub/ctrl/math.h>
+#include <iCub/iKin/iKinFwd.h>
+
+#include <IpTNLP.hpp>
+#include <IpIpoptCalculatedQuantities.hpp>
+
+#include <cer_kinematics/utils.h>
+#include <cer_kinematics/tripod.h>
+#include <cer_kinematics/tripod_kernel.h>
+#include <cer_kinematics/arm.h>
+#include <cer_kinematics/private/helpers.h>
+#include <cer_kinematics/private/fixed_math.h>
+
+// same environment in which arm.cpp compiles the NLPs
+#define DELTA_RHO       1e-6
+
+using namespace std;
+using namespace yarp::os;
+using namespace yarp::sig;
+using namespace yarp::math;
+using namespace iCub::ctrl;
+using namespace iCub::iKin;
+using namespace cer::kinematics;
+
+namespace cer {
+    namespace kinematics {
+        #include <cer_kinematics/private/arm_common.h>
+        #include <cer_kinematics/private/arm_nlp.h>
+    }
+}
+
+#if __cplusplus>=201103L
+    #define THROW_BAD_ALLOC
+    #define THROW_NOTHING   noexcept
+#else
+    #define THROW_BAD_ALLOC throw(std::bad_alloc)
+    #define THROW_NOTHING   throw()
+#endif
+
+
+/****************************************************************/
+namespace
+{
+    volatile long allocations=0;
+}
+
+
+#if defined(__GLIBC__)
+// hook the C allocator directly, which serves operator new as well
+extern "C"
+{
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t nmemb, size_t size);
+    void* __libc_realloc(void *ptr, size_t size);
+
+    /****************************************************************/
+    void* malloc(size_t size)
+    {
+        allocations++;
+        return __libc_malloc(size);
+    }
+
+    /****************************************************************/
+    void* calloc(size_t nmemb, size_t size)
+    {
+        allocations++;
+        return __libc_calloc(nmemb,size);
+    }
+
+    /****************************************************************/
+    void* realloc(void *ptr, size_t size)
+    {
+        allocations++;
+        return __libc_realloc(ptr,size);
+    }
+}
+#else
+/****************************************************************/
+void* operator new(size_t size) THROW_BAD_ALLOC
+{
+    allocations++;
+    if (void *ptr=malloc(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+
+/****************************************************************/
+void* operator new[](size_t size) THROW_BAD_ALLOC
+{
+    allocations++;
+    if (void *ptr=malloc(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+
+/****************************************************************/
+void operator delete(void *ptr) THROW_NOTHING
+{
+    free(ptr);
+}
+
+
+/****************************************************************/
+void operator delete[](void *ptr) THROW_NOTHING
+{
+    free(ptr);
+}
+#endif
+
+
+/****************************************************************/
+class Probe
+{
+    string name;
+    long allocs0;
+    double t0;
+
+public:
+    /****************************************************************/
+    Probe(const string &name_) : name(name_)
+    {
+        allocs0=allocations;
+        t0=Time::now();
+    }
+
+    /****************************************************************/
+    bool report(const int N) const
+    {
+        double dt=Time::now()-t0;
+        double allocs=(double)(allocations-allocs0)/N;
+        yInfo("%-28s allocations/call=%g; time/call [us]=%g",
+              name.c_str(),allocs,1e6*dt/N);
+        return (allocs==0.0);
+    }
+};
+
+
+/****************************************************************/
+template<class NLP>
+bool probe_nlp(ArmSolver &solver, const Matrix &Hd, const int N)
+{
+    NLP nlp(solver);
+    nlp.set_target(Hd);
+
+    Ipopt::Index n,m,nnz_jac_g,nnz_h_lag;
+    Ipopt::TNLP::IndexStyleEnum index_style;
+    nlp.get_nlp_info(n,m,nnz_jac_g,nnz_h_lag,index_style);
+
+    // buffers Ipopt would hand over to the callbacks
+    vector<Ipopt::Number> x0(n),x(n),x_l(n),x_u(n),grad_f(n);
+    vector<Ipopt::Number> g(m),g_l(m),g_u(m),lambda(m,1.0);
+    vector<Ipopt::Index> iRow_jac(nnz_jac_g),jCol_jac(nnz_jac_g);
+    vector<Ipopt::Number> jac(nnz_jac_g);
+    vector<Ipopt::Index> iRow_h(nnz_h_lag+1),jCol_h(nnz_h_lag+1);
+    vector<Ipopt::Number> h(nnz_h_lag+1);
+    Ipopt::Number f;
+
+    nlp.get_bounds_info(n,&x_l[0],&x_u[0],m,&g_l[0],&g_u[0]);
+    nlp.get_starting_point(n,true,&x0[0],false,NULL,NULL,m,false,NULL);
+    nlp.eval_jac_g(n,&x0[0],true,m,nnz_jac_g,&iRow_jac[0],&jCol_jac[0],NULL);
+    nlp.eval_h(n,&x0[0],true,1.0,m,&lambda[0],true,nnz_h_lag,&iRow_h[0],&jCol_h[0],NULL);
+
+    Probe probe(nlp.get_mode());
+    for (int i=0; i<N; i++)
+    {
+        // sweep the iterate within the bounds as the solver would do
+        double s=(i%100)/100.0;
+        for (Ipopt::Index j=0; j<n; j++)
+            x[j]=x_l[j]+s*(x_u[j]-x_l[j]);
+
+        nlp.eval_f(n,&x[0],true,f);
+        nlp.eval_grad_f(n,&x[0],false,&grad_f[0]);
+        nlp.eval_g(n,&x[0],false,m,&g[0]);
+        nlp.eval_jac_g(n,&x[0],false,m,nnz_jac_g,NULL,NULL,&jac[0]);
+        if (nnz_h_lag>0)
+            nlp.eval_h(n,&x[0],false,1.0,m,&lambda[0],false,nnz_h_lag,NULL,NULL,&h[0]);
+    }
+
+    return probe.report(N);
+}
+
+
+/****************************************************************/
+template<class NLP>
+bool check_derivatives(ArmSolver &solver, const Matrix &Hd)
+{
+    NLP nlp(solver);
+    nlp.set_target(Hd);
+
+    Ipopt::Index n,m,nnz_jac_g,nnz_h_lag;
+    Ipopt::TNLP::IndexStyleEnum index_style;
+    nlp.get_nlp_info(n,m,nnz_jac_g,nnz_h_lag,index_style);
+
+    // one spare entry at the end of the jacobian catches overruns
+    const double guard=std::numeric_limits<double>::max();
+    vector<Ipopt::Number> x(n),x_l(n),x_u(n),x_fd(n),grad_f(n);
+    vector<Ipopt::Number> g_l(m),g_u(m),g_fw(m),g_bw(m);
+    vector<Ipopt::Index> iRow(nnz_jac_g),jCol(nnz_jac_g);
+    vector<Ipopt::Number> jac(nnz_jac_g+1,guard);
+    vector<double> J(m*n,0.0);
+    Ipopt::Number f_fw,f_bw;
+
+    nlp.get_bounds_info(n,&x_l[0],&x_u[0],m,&g_l[0],&g_u[0]);
+    nlp.get_starting_point(n,true,&x[0],false,NULL,NULL,m,false,NULL);
+    for (Ipopt::Index j=0; j<n; j++)
+        x[j]=0.5*(x_l[j]+x_u[j]);
+
+    nlp.eval_jac_g(n,&x[0],true,m,nnz_jac_g,&iRow[0],&jCol[0],NULL);
+    nlp.eval_grad_f(n,&x[0],true,&grad_f[0]);
+    nlp.eval_jac_g(n,&x[0],false,m,nnz_jac_g,NULL,NULL,&jac[0]);
+    for (Ipopt::Index i=0; i<nnz_jac_g; i++)
+        J[iRow[i]*n+jCol[i]]+=jac[i];
+
+    // same criterion of the Ipopt "derivative_test" option
+    const double h=1e-6;
+    const double tol=1e-4;
+    double max_err=0.0;
+    bool ok=(jac[nnz_jac_g]==guard);
+    for (Ipopt::Index j=0; j<n; j++)
+    {
+        // variables pinned by the bounds are not in the problem
+        if (x_u[j]<=x_l[j])
+            continue;
+
+        x_fd=x;
+        x_fd[j]=x[j]+h;
+        nlp.eval_f(n,&x_fd[0],true,f_fw);
+        nlp.eval_g(n,&x_fd[0],false,m,&g_fw[0]);
+        x_fd[j]=x[j]-h;
+        nlp.eval_f(n,&x_fd[0],true,f_bw);
+        nlp.eval_g(n,&x_fd[0],false,m,&g_bw[0]);
+
+        double fd=(f_fw-f_bw)/(2.0*h);
+        max_err=std::max(max_err,fabs(grad_f[j]-fd)/std::max(1.0,fabs(fd)));
+        for (Ipopt::Index i=0; i<m; i++)
+        {
+            fd=(g_fw[i]-g_bw[i])/(2.0*h);
+            max_err=std::max(max_err,fabs(J[i*n+j]-fd)/std::max(1.0,fabs(fd)));
+        }
+    }
+
+    ok&=(max_err<=tol);
+    if (ok)
+        yInfo("%-28s derivatives ok; max relative error=%g",
+              nlp.get_mode().c_str(),max_err);
+    else
+        yError("%-28s derivatives mismatch; max relative error=%g%s",
+               nlp.get_mode().c_str(),max_err,
+               jac[nnz_jac_g]==guard?"":" (jacobian overrun)");
+
+    return ok;
+}
+
+
+/****************************************************************/
+template<bool full_pose, int configuration>
+bool probe_nlps(ArmSolver &solver, const Matrix &Hd, const int N)
+{
+    bool ok=probe_nlp<ArmNLP<full_pose,configuration,differentiation::forward> >(solver,Hd,N);
+    ok&=probe_nlp<ArmNLP<full_pose,configuration,differentiation::central> >(solver,Hd,N);
+    ok&=probe_nlp<ArmNLP<full_pose,configuration,differentiation::analytic> >(solver,Hd,N);
+    ok&=check_derivatives<ArmNLP<full_pose,configuration,differentiation::forward> >(solver,Hd);
+    ok&=check_derivatives<ArmNLP<full_pose,configuration,differentiation::central> >(solver,Hd);
+    ok&=check_derivatives<ArmNLP<full_pose,configuration,differentiation::analytic> >(solver,Hd);
+    return ok;
+}
+
+
+/****************************************************************/
+int main(int argc, char *argv[])
+{
+    ResourceFinder rf;
+    rf.configure(argc,argv);
+    int N=rf.check("N",Value(100000)).asInt();
+
+    TripodParameters params(0.09,0.0,0.17,30.0);
+    TripodSolver solver(params);
+    TripodKernel kernel(params);
+
+    // outputs are pre-sized by a first call
+    Vector lll(3,0.0),p,u,hpr;
+    Matrix H;
+    TripodFrame d;
+    solver.fkin(lll,p,u);
+    solver.fkin(lll,hpr);
+    solver.fkin(lll,H);
+
+    bool ok=true;
+    {
+        Probe probe("TripodKernel::fkin");
+        for (int i=0; i<N; i++)
+        {
+            lll[0]=0.17*(i%100)/100.0;
+            kernel.fkin(lll.data(),d);
+        }
+        ok&=probe.report(N);
+    }
+
+    {
+        Probe probe("TripodSolver::fkin(p,u)");
+        for (int i=0; i<N; i++)
+        {
+            lll[0]=0.17*(i%100)/100.0;
+            solver.fkin(lll,p,u);
+        }
+        ok&=probe.report(N);
+    }
+
+    {
+        Probe probe("TripodSolver::fkin(hpr)");
+        for (int i=0; i<N; i++)
+        {
+            lll[0]=0.17*(i%100)/100.0;
+            solver.fkin(lll,hpr);
+        }
+        ok&=probe.report(N);
+    }
+
+    {
+        Probe probe("TripodSolver::fkin(H)");
+        for (int i=0; i<N; i++)
+        {
+            lll[0]=0.17*(i%100)/100.0;
+            solver.fkin(lll,H);
+        }
+        ok&=probe.report(N);
+    }
+
+    // callbacks of the arm NLPs the way Ipopt drives them within
+    // one iteration, for all the differentiation schemes, whose
+    // gradients and jacobians are also checked against finite
+    // differences
+    ArmParameters armp("left");
+    ArmSolver arm(armp);
+
+    SolverParameters slvp=arm.getSolverParameters();
+    slvp.use_hessian=true;
+    arm.setSolverParameters(slvp);
+
+    Matrix Hd=eye(4,4);
+    Hd(0,3)=0.4; Hd(1,3)=0.1; Hd(2,3)=0.1;
+
+    int N_nlp=std::max(N/100,1);
+    ok&=probe_nlps<true,configuration::no_heave>(arm,Hd,N_nlp);
+    ok&=probe_nlps<true,configuration::heave>(arm,Hd,N_nlp);
+    ok&=probe_nlps<true,configuration::no_torso_no_heave>(arm,Hd,N_nlp);
+    ok&=probe_nlps<true,configuration::no_torso_heave>(arm,Hd,N_nlp);
+    ok&=probe_nlps<false,configuration::no_heave>(arm,Hd,N_nlp);
+    ok&=probe_nlps<false,configuration::heave>(arm,Hd,N_nlp);
+    ok&=probe_nlps<false,configuration::no_torso_no_heave>(arm,Hd,N_nlp);
+    ok&=probe_nlps<false,configuration::no_torso_heave>(arm,Hd,N_nlp);
+
+    if (!ok)
+        yError("detected heap allocations in the hot path or wrong derivatives!");
+
+    return (ok?0:1);
+}
+
@@ -18,158 +18,565 @@
 #include <cmath>
 #include <string>
 #include <sstream>
+#include <fstream>
+#include <algorithm>
+#include <vector>
 #include <deque>
 
 #include <yarp/os/all.h>
 #include <yarp/sig/all.h>
 #include <yarp/math/Math.h>
+#include <yarp/math/Rand.h>
 
 #include <iCub/iKin/iKinFwd.h>
 
 #include <cer_kinematics/arm.h>
-#include <cer_kinematics_alt/Solver.h>
+#include <cer_kinematics/tripod_kernel.h>
+#include <R1Controller.h>
 
 #define R2D     (180.0/M_PI)
 
+// the alternative stack brings its own Matrix in the global
+// namespace, hence yarp matrices are always fully qualified
 using namespace std;
 using namespace yarp::os;
 using namespace yarp::sig;
 using namespace yarp::math;
 using namespace iCub::iKin;
 using namespace cer::kinematics;
-using namespace cer::kinematics_alt;
+using namespace cer::kinematics_alt::r1;
 
 
 /****************************************************************/
 struct Input
 {
-    Vector xd;
-    Vector ud;
-    Matrix Hd;
+    Vector q;
+    yarp::sig::Matrix Hd;
     double torso_heave;
     double lower_arm_heave;
-    Input() : xd(3,0.0), ud(4,0.0), Hd(eye(4,4)),
-              torso_heave(0.0), lower_arm_heave(0.0) { }
-    void calcHd()
+};
+
+
+/****************************************************************/
+struct Output
+{
+    Vector q;
+    double dt;
+    double e_x,e_u;
+    double e_h1,e_h2;
+    double alpha1,alpha2;
+    bool joints_ok;
+    bool tilt_ok;
+};
+
+
+/****************************************************************/
+class Samples
+{
+    vector<double> values;
+
+public:
+    /****************************************************************/
+    void add(const double val)
+    {
+        values.push_back(val);
+    }
+
+    /****************************************************************/
+    double percentile(const double p) const
+    {
+        if (values.empty())
+            return 0.0;
+
+        // nearest-rank percentile
+        vector<double> sorted=values;
+        size_t k=(size_t)ceil((p/100.0)*sorted.size());
+        k=(k>0)?k-1:0;
+        nth_element(sorted.begin(),sorted.begin()+k,sorted.end());
+        return sorted[k];
+    }
+};
+
+
+/****************************************************************/
+struct Metrics
+{
+    Samples dt,e_x,e_u,e_h;
+    int successes,joints_violations,tilt_violations,N;
+
+    /****************************************************************/
+    Metrics() : successes(0), joints_violations(0),
+                tilt_violations(0), N(0) { }
+
+    /****************************************************************/
+    void update(const Output &out, const double tol_pos,
+                const double tol_ang)
     {
-        Hd=axis2dcm(ud);
-        Hd.setSubcol(xd,0,3);
+        dt.add(out.dt);
+        e_x.add(out.e_x);
+        e_u.add(out.e_u);
+        e_h.add(std::max(out.e_h1,out.e_h2));
+
+        joints_violations+=(out.joints_ok?0:1);
+        tilt_violations+=(out.tilt_ok?0:1);
+        successes+=((out.e_x<=tol_pos) && (R2D*out.e_u<=tol_ang) &&
+                    out.joints_ok && out.tilt_ok)?1:0;
+        N++;
+    }
+
+    /****************************************************************/
+    void fill(const string &stack, Property &prop) const
+    {
+        prop.put((stack+"_success_rate").c_str(),(N>0)?(double)successes/N:0.0);
+        prop.put((stack+"_joints_violations").c_str(),joints_violations);
+        prop.put((stack+"_tilt_violations").c_str(),tilt_violations);
+        prop.put((stack+"_dt_p50").c_str(),dt.percentile(50.0));
+        prop.put((stack+"_dt_p99").c_str(),dt.percentile(99.0));
+        prop.put((stack+"_e_x_p50").c_str(),e_x.percentile(50.0));
+        prop.put((stack+"_e_x_p99").c_str(),e_x.percentile(99.0));
+        prop.put((stack+"_e_u_p50").c_str(),e_u.percentile(50.0));
+        prop.put((stack+"_e_u_p99").c_str(),e_u.percentile(99.0));
+        prop.put((stack+"_e_h_p99").c_str(),e_h.percentile(99.0));
     }
 };
 
 
 /****************************************************************/
-int main()
+class Dataset
 {
-    // define inputs
+    ArmParameters &armParams;
+    ArmSolver &solver;
+
+    /****************************************************************/
+    bool withinCone(const TripodKernel &kernel, const TripodParameters &params,
+                    const double *lll) const
+    {
+        TripodFrame d,din;
+        kernel.fkin(lll,d,&din);
+        return (din.n[2]>=cos(params.alpha_max/R2D));
+    }
+
+    /****************************************************************/
+    void draw(RandScalar &rnd, const TripodKernel &kernel,
+              const TripodParameters &params, double *lll) const
+    {
+        // elongations drawn independently mostly bend the platform
+        // beyond alpha_max, hence they are redrawn until within the
+        // cone
+        do
+        {
+            for (int i=0; i<3; i++)
+                lll[i]=rnd.get(params.l_min,params.l_max);
+        }
+        while (!withinCone(kernel,params,lll));
+    }
+
+public:
     deque<Input> input;
-    Input in;
-    
-    // input #0
-    in.torso_heave=0.05;
-    in.lower_arm_heave=0.01;
-    in.xd[0]=0.2; in.xd[1]=-0.4; in.xd[2]=0.35;
-    in.ud[0]=0.0; in.ud[1]=1.0;  in.ud[2]=0.0;  in.ud[3]=M_PI/2.0;
-    in.calcHd();
-    input.push_back(in);
-
-    // input #1
-    in.torso_heave=0.05;
-    in.lower_arm_heave=0.01;
-    in.xd[0]=0.2; in.xd[1]=-0.6; in.xd[2]=0.35;
-    in.ud[0]=0.0; in.ud[1]=1.0;  in.ud[2]=0.0;  in.ud[3]=M_PI/2.0;
-    in.calcHd();
-    input.push_back(in);
-
-    // input #2
-    in.torso_heave=0.05;
-    in.lower_arm_heave=0.0;
-    in.xd[0]=0.4; in.xd[1]=-0.2; in.xd[2]=0.25;
-    in.ud[0]=0.0; in.ud[1]=1.0;  in.ud[2]=0.0;  in.ud[3]=M_PI/2.0;
-    in.calcHd();
-    input.push_back(in);
+
+    /****************************************************************/
+    Dataset(ArmParameters &armParams_, ArmSolver &solver_) :
+            armParams(armParams_), solver(solver_) { }
+
+    /****************************************************************/
+    void generate(const int seed, const int N)
+    {
+        // targets stem from random configurations within the
+        // bounds, tripods' bending included, so that they are
+        // attainable
+        RandScalar rnd(seed);
+        TripodKernel torso(armParams.torso),lower_arm(armParams.lower_arm);
+        iKinChain &chain=*armParams.upper_arm.asChain();
+        size_t L=3+chain.getDOF();
+
+        input.clear();
+        for (int n=0; n<N; n++)
+        {
+            Input in;
+            in.q.resize(L+3);
+            draw(rnd,torso,armParams.torso,in.q.data());
+            draw(rnd,lower_arm,armParams.lower_arm,in.q.data()+L);
+
+            for (size_t i=0; i<chain.getDOF(); i++)
+                in.q[3+i]=R2D*rnd.get(chain[i].getMin(),chain[i].getMax());
+
+            solver.fkin(in.q,in.Hd);
+
+            TripodFrame d,din;
+            torso.fkin(in.q.data(),d,&din);
+            in.torso_heave=din.p[2];
+            lower_arm.fkin(in.q.data()+L,d,&din);
+            in.lower_arm_heave=din.p[2];
+
+            input.push_back(in);
+        }
+    }
+
+    /****************************************************************/
+    bool save(const string &file) const
+    {
+        ofstream fout(file.c_str());
+        if (!fout.is_open())
+        {
+            yError("unable to open \"%s\"!",file.c_str());
+            return false;
+        }
+
+        // heaves, target position and (axis,angle), configuration
+        fout.precision(12);
+        for (size_t n=0; n<input.size(); n++)
+        {
+            const Input &in=input[n];
+            Vector xd=in.Hd.getCol(3).subVector(0,2);
+            Vector ud=dcm2axis(in.Hd);
+
+            fout<<in.torso_heave<<" "<<in.lower_arm_heave;
+            for (size_t i=0; i<3; i++)
+                fout<<" "<<xd[i];
+            for (size_t i=0; i<4; i++)
+                fout<<" "<<ud[i];
+            for (size_t i=0; i<in.q.length(); i++)
+                fout<<" "<<in.q[i];
+            fout<<endl;
+        }
+
+        return true;
+    }
+
+    /****************************************************************/
+    bool load(const string &file)
+    {
+        ifstream fin(file.c_str());
+        if (!fin.is_open())
+            return false;
+
+        TripodKernel torso(armParams.torso),lower_arm(armParams.lower_arm);
+        size_t L=3+armParams.upper_arm.getDOF()+3;
+
+        input.clear();
+        string line;
+        while (getline(fin,line))
+        {
+            istringstream stream(line);
+            Input in;
+            Vector xd(3),ud(4);
+            in.q.resize(L);
+
+            stream>>in.torso_heave>>in.lower_arm_heave;
+            for (size_t i=0; i<3; i++)
+                stream>>xd[i];
+            for (size_t i=0; i<4; i++)
+                stream>>ud[i];
+            for (size_t i=0; i<L; i++)
+                stream>>in.q[i];
+
+            if (stream.fail())
+                continue;
+
+            // datasets drawn regardless of the bending are discarded
+            if (!withinCone(torso,armParams.torso,in.q.data()) ||
+                !withinCone(lower_arm,armParams.lower_arm,in.q.data()+L-3))
+            {
+                yWarning("\"%s\" holds unattainable targets: discarded",file.c_str());
+                input.clear();
+                return false;
+            }
+
+            in.Hd=axis2dcm(ud);
+            in.Hd.setSubcol(xd,0,3);
+            input.push_back(in);
+        }
+
+        return !input.empty();
+    }
+};
+
+
+/****************************************************************/
+class AltSolver
+{
+    R1Model model;
+    R1Controller ctrl;
+    vector<int> map;
+    bool left;
+
+public:
+    /****************************************************************/
+    AltSolver(const string &arm_type) : ctrl(&model), left(arm_type=="left")
+    {
+        // torso and torso_yaw are shared, while the right arm
+        // comes after the left one
+        for (int i=0; i<12; i++)
+            map.push_back(((i<4) || left)?i:i+8);
+    }
+
+    /****************************************************************/
+    bool ikin(const Input &in, const int max_steps, const double tol_pos,
+              const double tol_ang, Vector &q, double &e_x, double &e_u)
+    {
+        double torso=(in.q[0]+in.q[1]+in.q[2])/3.0;
+        double arm=(in.q[9]+in.q[10]+in.q[11])/3.0;
+        ctrl.setExtensions(torso,left?arm:DEFAULT_ARM_EXTENSION,
+                           left?DEFAULT_ARM_EXTENSION:arm);
+
+        // the stack is fed with the target it attains in the
+        // sampled configuration, since its model has its own
+        // root frame
+        cer::robot_model::Matrix qa=ctrl.getZeroConfig();
+        cer::robot_model::Matrix qd=qa;
+        for (size_t i=0; i<map.size(); i++)
+            qd(map[i])=in.q[i];
+
+        model.calcConfig(qd);
+        Transform Hd=left?model.getHandTransformL():model.getHandTransformR();
+
+        // resolved-rate loop
+        cer::robot_model::Matrix qdot(qa.R);
+        bool converged=false;
+        for (int step=0; step<max_steps; step++)
+        {
+            model.calcConfig(qa);
+            Transform H=left?model.getHandTransformL():model.getHandTransformR();
+
+            Vec3 ex=Hd.Pj()-H.Pj();
+            Quaternion eq=Hd.Rj().quaternion()*H.Rj().quaternion().conj();
+            e_x=ex.mod();
+            e_u=2.0*atan2(eq.V.mod(),fabs(eq.s));
+            if ((e_x<=tol_pos) && (R2D*e_u<=tol_ang))
+            {
+                converged=true;
+                break;
+            }
+
+            Vec3 v=5.0*ex;
+            Vec3 w=5.0*eq.V;
+            double v3[]={v.x,v.y,v.z};
+            double w3[]={w.x,w.y,w.z};
+            if (left)
+                ctrl.velControl(qa,qdot,v3,w3,NULL,NULL);
+            else
+                ctrl.velControl(qa,qdot,NULL,NULL,v3,w3);
+
+            // the head is not involved
+            qdot(qa.R-2)=qdot(qa.R-1)=0.0;
+            for (int j=0; j<qa.R; j++)
+                qa(j)+=qdot(j)*PERIOD;
+        }
+
+        q.resize(map.size());
+        for (size_t i=0; i<map.size(); i++)
+            q[i]=qa(map[i]);
+
+        return converged;
+    }
+};
+
+
+/****************************************************************/
+void checkConstraints(ArmSolver &solver, ArmParameters &armParams,
+                      const Input &in, Output &out)
+{
+    const Vector &q=out.q;
+    iKinChain &c=*armParams.upper_arm.asChain();
+    size_t L=3+armParams.upper_arm.getN();
+
+    out.joints_ok=true;
+    for (size_t j=0; j<3; j++)
+        out.joints_ok&=((q[j]>=armParams.torso.l_min) && (q[j]<=armParams.torso.l_max));
+    for (size_t j=0; j<armParams.upper_arm.getN(); j++)
+        out.joints_ok&=((q[3+j]>=R2D*c[j].getMin()) && (q[3+j]<=R2D*c[j].getMax()));
+    for (size_t j=L; j<q.length(); j++)
+        out.joints_ok&=((q[j]>=armParams.lower_arm.l_min) && (q[j]<=armParams.lower_arm.l_max));
+
+    yarp::sig::Matrix H_tmp0,H_tmp1;
+    solver.fkin(q,H_tmp0,0);
+    H_tmp0=SE3inv(armParams.torso.T0)*H_tmp0;
+    out.e_h1=fabs(in.torso_heave-H_tmp0(2,3));
+    out.alpha1=R2D*acos(std::max(-1.0,std::min(1.0,H_tmp0(2,2))));
+
+    solver.fkin(q,H_tmp1,8);
+    solver.fkin(q,H_tmp0,9);
+    H_tmp0=SE3inv(H_tmp1*armParams.lower_arm.T0)*H_tmp0;
+    out.e_h2=fabs(in.lower_arm_heave-H_tmp0(2,3));
+    out.alpha2=R2D*acos(std::max(-1.0,std::min(1.0,H_tmp0(2,2))));
+
+    // a small slack accounts for the constraints tolerance
+    out.tilt_ok=(out.alpha1<=armParams.torso.alpha_max+0.1) &&
+                (out.alpha2<=armParams.lower_arm.alpha_max+0.1);
+}
+
+
+/****************************************************************/
+bool compare(const Property &current, const Property &baseline,
+             const string &key, const double rel_tol, const double abs_tol,
+             const bool higher_is_better)
+{
+    if (!baseline.check(key.c_str()))
+    {
+        yWarning("%s: missing from the baseline",key.c_str());
+        return true;
+    }
+
+    double cur=current.find(key.c_str()).asDouble();
+    double ref=baseline.find(key.c_str()).asDouble();
+    double margin=rel_tol*fabs(ref)+abs_tol;
+    bool ok=higher_is_better?(cur>=ref-margin):(cur<=ref+margin);
+
+    if (ok)
+        yInfo("%s: %g (baseline %g) ok",key.c_str(),cur,ref);
+    else
+        yError("%s: %g (baseline %g) regressed",key.c_str(),cur,ref);
+    return ok;
+}
+
+
+/****************************************************************/
+int main(int argc, char *argv[])
+{
+    ResourceFinder rf;
+    rf.configure(argc,argv);
+
+    // command-line options
+    string arm_type=rf.check("arm-type",Value("left")).asString().c_str();
+    string mode=rf.check("mode",Value("full_pose+heave")).asString().c_str();
+    int seed=rf.check("seed",Value(1)).asInt();
+    int targets=rf.check("targets",Value(1000)).asInt();
+    string dataset_file=rf.check("dataset",Value("b2b-dataset-"+arm_type+".txt")).asString().c_str();
+    string baseline_file=rf.check("baseline",Value("b2b-baseline-"+arm_type+".ini")).asString().c_str();
+    bool update_baseline=rf.check("update-baseline");
+    bool skip_alt=rf.check("skip-alt");
+    int alt_max_steps=rf.check("alt-max-steps",Value(2000)).asInt();
+    double tol_pos=rf.check("tol-pos",Value(0.005)).asDouble();
+    double tol_ang=rf.check("tol-ang",Value(2.0)).asDouble();
+    double tol_latency=rf.check("tol-latency",Value(0.25)).asDouble();
+    double tol_accuracy=rf.check("tol-accuracy",Value(0.1)).asDouble();
+    double tol_success=rf.check("tol-success",Value(0.01)).asDouble();
 
     // declare solvers
-    ArmParameters armParams("left");
+    ArmParameters armParams(arm_type);
 
     ArmSolver solver_0;
     solver_0.setArmParameters(armParams);
-    solver_0.setVerbosity(1);
 
     SolverParameters p=solver_0.getSolverParameters();
-    p.setMode("full_pose");
-    p.warm_start=true;
+    if (!p.setMode(mode))
+    {
+        yError("unrecognized mode \"%s\"!",mode.c_str());
+        return 1;
+    }
+    p.warm_start=false;
+    p.tracking=false;
     solver_0.setSolverParameters(p);
 
-    KinR1 solver_1;
+    AltSolver solver_1(arm_type);
+
+    // the dataset is generated once and then kept fixed
+    Dataset dataset(armParams,solver_0);
+    if (!dataset.load(dataset_file))
+    {
+        yInfo("generating %d targets with seed %d ...",targets,seed);
+        dataset.generate(seed,targets);
+        if (!dataset.save(dataset_file))
+            return 1;
+        yInfo("dataset saved to \"%s\"",dataset_file.c_str());
+    }
 
-    // compute outputs and verify results
-    for (size_t i=0; i<input.size(); i++)
+    Metrics metrics_0,metrics_1;
+    size_t L=3+armParams.upper_arm.getDOF()+3;
+    for (size_t i=0; i<dataset.input.size(); i++)
     {
-        yInfo()<<"INPUT #"<<i<<" --------------------------------------------";
+        const Input &in=dataset.input[i];
 
-        Vector q_0(12,0.0);
+        Output out_0;
         SolverParameters p=solver_0.getSolverParameters();
-        p.torso_heave=input[i].torso_heave;
-        p.lower_arm_heave=input[i].lower_arm_heave;
+        p.torso_heave=in.torso_heave;
+        p.lower_arm_heave=in.lower_arm_heave;
         solver_0.setSolverParameters(p);
-        solver_0.setInitialGuess(q_0);
-        solver_0.ikin(input[i].Hd,q_0);
+        solver_0.setInitialGuess(Vector(L,0.0));
 
-        Vector q_1(12,0.0);
         double t0=Time::now();
-        solver_1.ikin_left_solver(input[i].Hd,q_1,
-                                  input[i].lower_arm_heave,
-                                  input[i].lower_arm_heave,
-                                  input[i].torso_heave);
-        double t1=Time::now();
-
-        Matrix H_1;
-        solver_1.fkin(q_1,H_1);
-
-        Vector x_1=H_1.getCol(3).subVector(0,2);
-        Vector u_1=dcm2axis(H_1);
-
-        ostringstream jconstr;
-        for (size_t j=0; j<3; j++)
-            jconstr<<(((q_1[j]>=armParams.torso.l_min)&&(q_1[j]<=armParams.torso.l_max))?"ok":"fail")<<" ";
-
-        iKinChain &c=*armParams.upper_arm.asChain();
-        for (size_t j=0; j<armParams.upper_arm.getN(); j++)
-            jconstr<<(((q_1[3+j]>=R2D*c[j].getMin())&&(q_1[3+j]<=R2D*c[j].getMax()))?"ok":"fail")<<" ";
-
-        for (size_t j=3+armParams.upper_arm.getN(); j<q_1.length(); j++)
-            jconstr<<(((q_1[j]>=armParams.lower_arm.l_min)&&(q_1[j]<=armParams.lower_arm.l_max))?"ok":"fail")<<" ";
-
-        Matrix H_tmp0;
-        solver_0.fkin(q_1,H_tmp0,0);
-        H_tmp0=SE3inv(armParams.torso.T0)*H_tmp0; 
-        double h1=H_tmp0(2,3);
-        double alpha1=R2D*acos(H_tmp0(2,2));
-
-        Matrix H_tmp1;
-        solver_0.fkin(q_1,H_tmp1,8);
-        solver_0.fkin(q_1,H_tmp0,9);
-        H_tmp0=SE3inv(H_tmp1*armParams.lower_arm.T0)*H_tmp0; 
-        double h2=H_tmp0(2,3);
-        double alpha2=R2D*acos(H_tmp0(2,2));
-
-        Vector e_u=dcm2axis(input[i].Hd*H_1.transposed());
-        e_u*=e_u[3]; e_u.pop_back();
-
-        yInfo()<<"           q_1 [*] = ("<<q_1.toString(5,5).c_str()<<")";
-        yInfo()<<"joints-constraints = ("<<jconstr.str()<<")";
-        yInfo()<<"         e_x_1 [m] = "<<norm(input[i].xd-x_1);
-        yInfo()<<"       e_u_1 [rad] = "<<norm(e_u);
-        yInfo()<<"        e_h1_1 [m] = "<<fabs(input[i].torso_heave-h1);
-        yInfo()<<"    alpha1_1 [deg] = "<<alpha1<<" ("<<(alpha1<=armParams.torso.alpha_max?"ok":"fail")<<")";
-        yInfo()<<"        e_h2_1 [m] = "<<fabs(input[i].lower_arm_heave-h2);
-        yInfo()<<"    alpha1_2 [deg] = "<<alpha2<<" ("<<(alpha2<=armParams.lower_arm.alpha_max?"ok":"fail")<<")";
-        yInfo()<<"         dt_1 [ms] = "<<1000.0*(t1-t0);
-        yInfo()<<"";
-        yInfo()<<"";
+        solver_0.ikin(in.Hd,out_0.q);
+        out_0.dt=Time::now()-t0;
+
+        yarp::sig::Matrix H_0;
+        solver_0.fkin(out_0.q,H_0);
+        Vector e_u=dcm2axis(in.Hd*H_0.transposed());
+        out_0.e_x=norm(in.Hd.getCol(3).subVector(0,2)-H_0.getCol(3).subVector(0,2));
+        out_0.e_u=p.full_pose?fabs(e_u[3]):0.0;
+        checkConstraints(solver_0,armParams,in,out_0);
+        metrics_0.update(out_0,tol_pos,p.full_pose?tol_ang:180.0);
+
+        if (!skip_alt)
+        {
+            Output out_1;
+            t0=Time::now();
+            solver_1.ikin(in,alt_max_steps,tol_pos,tol_ang,out_1.q,out_1.e_x,out_1.e_u);
+            out_1.dt=Time::now()-t0;
+            checkConstraints(solver_0,armParams,in,out_1);
+            metrics_1.update(out_1,tol_pos,tol_ang);
+        }
+
+        if ((i%100)==0)
+            yInfo("target %d/%d",(int)i,(int)dataset.input.size());
     }
 
+    Property current;
+    metrics_0.fill("cer_kinematics",current);
+    if (!skip_alt)
+        metrics_1.fill("cer_kinematics_alt",current);
+    yInfo("%s",current.toString().c_str());
+
+    // a missing baseline is not a pass: recording one is explicit
+    Property baseline;
+    if (!update_baseline && !baseline.fromConfigFile(baseline_file.c_str()))
+    {
+        yError("no baseline found in \"%s\": run with --update-baseline to record one",
+               baseline_file.c_str());
+        return 1;
+    }
+
+    if (update_baseline)
+    {
+        ofstream fout(baseline_file.c_str());
+        if (!fout.is_open())
+        {
+            yError("unable to open \"%s\"!",baseline_file.c_str());
+            return 1;
+        }
+
+        Bottle b(current.toString().c_str());
+        for (int i=0; i<b.size(); i++)
+            if (Bottle *entry=b.get(i).asList())
+                fout<<entry->toString().c_str()<<endl;
+
+        yInfo("baseline saved to \"%s\"",baseline_file.c_str());
+        return 0;
+    }
+
+    // latency depends on the machine, thus its tolerance is
+    // looser than the accuracy one
+    bool ok=true;
+    for (int s=0; s<(skip_alt?1:2); s++)
+    {
+        string stack=(s==0)?"cer_kinematics":"cer_kinematics_alt";
+        ok&=compare(current,baseline,stack+"_success_rate",0.0,tol_success,true);
+        ok&=compare(current,baseline,stack+"_joints_violations",0.0,0.0,false);
+        ok&=compare(current,baseline,stack+"_tilt_violations",0.0,0.0,false);
+        ok&=compare(current,baseline,stack+"_dt_p50",tol_latency,0.0,false);
+        ok&=compare(current,baseline,stack+"_dt_p99",tol_latency,0.0,false);
+        ok&=compare(current,baseline,stack+"_e_x_p50",tol_accuracy,1e-6,false);
+        ok&=compare(current,baseline,stack+"_e_x_p99",tol_accuracy,1e-6,false);
+        ok&=compare(current,baseline,stack+"_e_u_p50",tol_accuracy,1e-6,false);
+        ok&=compare(current,baseline,stack+"_e_u_p99",tol_accuracy,1e-6,false);
+        ok&=compare(current,baseline,stack+"_e_h_p99",tol_accuracy,1e-6,false);
+    }
+
+    if (!ok)
+    {
+        yError("regression detected against \"%s\"",baseline_file.c_str());
+        return 1;
+    }
+
+    yInfo("no regression against \"%s\"",baseline_file.c_str());
     return 0;
 }
-
@@ -0,0 +1,435 @@
+/*
+ * Copyright (C) 2015 iCub Facility - Istituto Italiano di Tecnologia
+ * Author: Ugo Pattacini
+ * email:  ugo.pattacini@iit.it
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+*/
+
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+#include <deque>
+
+#include <yarp/os/all.h>
+#include <yarp/sig/all.h>
+#include <yarp/math/Math.h>
+#include <yarp/math/Rand.h>
+
+#include <iCub/ctrl/math.h>
+
+#include <cer_kinematics/arm.h>
+#include <cer_kinematics/head.h>
+#include <cer_kinematics/tripod.h>
+#include <cer_kinematics/tripod_kernel.h>
+
+using namespace std;
+using namespace yarp::os;
+using namespace yarp::sig;
+using namespace yarp::math;
+using namespace iCub::ctrl;
+using namespace iCub::iKin;
+using namespace cer::kinematics;
+
+
+/****************************************************************/
+class Samples
+{
+    vector<double> values;
+
+    /****************************************************************/
+    double percentile(const double p) const
+    {
+        // nearest-rank percentile
+        vector<double> sorted=values;
+        size_t k=(size_t)ceil((p/100.0)*sorted.size());
+        k=(k>0)?k-1:0;
+        nth_element(sorted.begin(),sorted.begin()+k,sorted.end());
+        return sorted[k];
+    }
+
+public:
+    /****************************************************************/
+    void add(const double val)
+    {
+        values.push_back(val);
+    }
+
+    /****************************************************************/
+    string toJSON(const double scale=1.0) const
+    {
+        ostringstream stream;
+        if (values.empty())
+            stream<<"null";
+        else
+        {
+            double avg=0.0;
+            for (size_t i=0; i<values.size(); i++)
+                avg+=values[i];
+            avg/=values.size();
+
+            stream<<"{\"p50\": "<<scale*percentile(50.0)
+                  <<", \"p90\": "<<scale*percentile(90.0)
+                  <<", \"p99\": "<<scale*percentile(99.0)
+                  <<", \"max\": "<<scale*(*max_element(values.begin(),values.end()))
+                  <<", \"avg\": "<<scale*avg<<"}";
+        }
+        return stream.str();
+    }
+};
+
+
+/****************************************************************/
+struct Report
+{
+    Samples latency,iterations;
+    Samples error1,error2;
+    int successes,N;
+
+    /****************************************************************/
+    Report() : successes(0), N(0) { }
+
+    /****************************************************************/
+    string toJSON(const string &name, const string &error1_name,
+                  const string &error2_name, const bool has_iterations) const
+    {
+        ostringstream stream;
+        stream<<"{\"name\": \""<<name<<"\""
+              <<", \"targets\": "<<N
+              <<", \"success_rate\": "<<((N>0)?(double)successes/N:0.0)
+              <<", \"latency_ms\": "<<latency.toJSON(1000.0);
+        if (has_iterations)
+            stream<<", \"iterations\": "<<iterations.toJSON();
+        stream<<", \""<<error1_name<<"\": "<<error1.toJSON();
+        if (!error2_name.empty())
+            stream<<", \""<<error2_name<<"\": "<<error2.toJSON();
+        stream<<"}";
+        return stream.str();
+    }
+};
+
+
+/****************************************************************/
+struct ArmTarget
+{
+    Matrix Hd;
+    double torso_heave;
+    double lower_arm_heave;
+};
+
+
+/****************************************************************/
+void getList(ResourceFinder &rf, const string &key, const Bottle &def,
+             Bottle &list)
+{
+    list=def;
+    if (Bottle *b=rf.find(key.c_str()).asList())
+        list=*b;
+    else if (rf.check(key.c_str()))
+    {
+        list.clear();
+        list.add(rf.find(key.c_str()));
+    }
+}
+
+
+/****************************************************************/
+void drawTripodElongations(RandScalar &rnd, const TripodParameters &params,
+                           double *lll)
+{
+    // elongations drawn independently mostly bend the platform
+    // beyond alpha_max, hence they are redrawn until within the cone
+    TripodKernel kernel(params);
+    double cos_alpha_max=cos(CTRL_DEG2RAD*params.alpha_max);
+    TripodFrame d,din;
+    do
+    {
+        for (int i=0; i<3; i++)
+            lll[i]=rnd.get(params.l_min,params.l_max);
+        kernel.fkin(lll,d,&din);
+    }
+    while (din.n[2]<cos_alpha_max);
+}
+
+
+/****************************************************************/
+Vector drawArmConfiguration(RandScalar &rnd, ArmParameters &armp,
+                            const bool fixed_torso)
+{
+    iKinChain &chain=*armp.upper_arm.asChain();
+    size_t L=3+chain.getDOF();
+
+    // with no torso the solver keeps the torso and the torso yaw
+    // of the initial guess, which is the home configuration
+    Vector q(L+3,0.0);
+    if (!fixed_torso)
+        drawTripodElongations(rnd,armp.torso,q.data());
+    drawTripodElongations(rnd,armp.lower_arm,q.data()+L);
+
+    for (size_t i=(fixed_torso?1:0); i<chain.getDOF(); i++)
+        q[3+i]=CTRL_RAD2DEG*rnd.get(chain[i].getMin(),chain[i].getMax());
+
+    return q;
+}
+
+
+/****************************************************************/
+Report benchmarkArm(ArmParameters &armp, const string &mode,
+                    const deque<ArmTarget> &targets)
+{
+    ArmSolver solver(armp);
+    SolverParameters slvp=solver.getSolverParameters();
+    slvp.setMode(mode);
+    slvp.warm_start=false;
+    slvp.tracking=false;
+    solver.setSolverParameters(slvp);
+    solver.setStatsBufferSize(0);
+
+    Vector q0(3+armp.upper_arm.getDOF()+3,0.0);
+    Report report;
+    for (size_t i=0; i<targets.size(); i++)
+    {
+        const ArmTarget &target=targets[i];
+        slvp.torso_heave=target.torso_heave;
+        slvp.lower_arm_heave=target.lower_arm_heave;
+        solver.setSolverParameters(slvp);
+
+        // targets are independent, hence the same initial guess
+        solver.setInitialGuess(q0);
+
+        Vector q;
+        ArmSolverStats stats;
+        double t0=Time::now();
+        bool ret=solver.ikin(target.Hd,q,stats);
+        report.latency.add(Time::now()-t0);
+        report.iterations.add(stats.iterations);
+
+        Matrix H;
+        solver.fkin(q,H);
+        double e_x=norm(target.Hd.getCol(3).subVector(0,2)-H.getCol(3).subVector(0,2));
+        double e_u=CTRL_RAD2DEG*fabs(dcm2axis(target.Hd*H.transposed())[3]);
+        report.error1.add(e_x);
+        if (slvp.full_pose)
+            report.error2.add(e_u);
+
+        report.successes+=(ret?1:0);
+        report.N++;
+    }
+
+    return report;
+}
+
+
+/****************************************************************/
+Report benchmarkHead(const string &type, RandScalar &rnd, const int N)
+{
+    HeadParameters headp(type);
+    HeadSolver solver(headp);
+
+    iKinChain &chain=*headp.head.asChain();
+    Vector q0(3+chain.getDOF(),0.0);
+
+    Report report;
+    for (int i=0; i<N; i++)
+    {
+        // the solver holds the torso and the torso yaw (joint 0)
+        // at q0, thus fixation points lying along the axis of a
+        // random configuration of the neck are attainable
+        Vector qt=q0;
+        for (size_t j=1; j<chain.getDOF(); j++)
+            qt[3+j]=CTRL_RAD2DEG*rnd.get(chain[j].getMin(),chain[j].getMax());
+
+        Matrix Ht;
+        solver.fkin(qt,Ht);
+        Vector xd=Ht.getCol(3).subVector(0,2)+rnd.get(0.5,2.0)*Ht.getCol(2).subVector(0,2);
+
+        solver.setInitialGuess(q0);
+
+        Vector q;
+        double t0=Time::now();
+        bool ret=solver.ikin(xd,q);
+        report.latency.add(Time::now()-t0);
+
+        Matrix H;
+        solver.fkin(q,H);
+        Vector d=xd-H.getCol(3).subVector(0,2);
+        double cos_ang=dot(H.getCol(2).subVector(0,2),d)/norm(d);
+        report.error1.add(CTRL_RAD2DEG*acos(std::max(-1.0,std::min(1.0,cos_ang))));
+
+        report.successes+=(ret?1:0);
+        report.N++;
+    }
+
+    return report;
+}
+
+
+/****************************************************************/
+Report benchmarkTripod(const TripodParameters &params, RandScalar &rnd,
+                       const int N)
+{
+    TripodSolver solver(params);
+
+    Report report;
+    for (int i=0; i<N; i++)
+    {
+        Vector hpr(3);
+        hpr[0]=rnd.get(params.l_min,params.l_max);
+        hpr[1]=rnd.get(-params.alpha_max,params.alpha_max);
+        hpr[2]=rnd.get(-params.alpha_max,params.alpha_max);
+
+        Vector lll;
+        double t0=Time::now();
+        bool ret=solver.ikin(hpr,lll);
+        report.latency.add(Time::now()-t0);
+
+        Vector ypr(3,0.0);
+        ypr[1]=CTRL_DEG2RAD*hpr[1];
+        ypr[2]=CTRL_DEG2RAD*hpr[2];
+        Matrix Hd=ypr2dcm(ypr);
+
+        Matrix H;
+        solver.fkin(lll,H);
+        report.error1.add(fabs(hpr[0]-H(2,3)));
+        report.error2.add(CTRL_RAD2DEG*fabs(dcm2axis(Hd*H.transposed())[3]));
+
+        report.successes+=(ret?1:0);
+        report.N++;
+    }
+
+    return report;
+}
+
+
+/****************************************************************/
+int main(int argc, char *argv[])
+{
+    ResourceFinder rf;
+    rf.configure(argc,argv);
+
+    // command-line options
+    string arm_type=rf.check("arm-type",Value("left")).asString().c_str();
+    string head_type=rf.check("head-type",Value("gaze")).asString().c_str();
+    int N=std::max(rf.check("targets",Value(100)).asInt(),1);
+    int seed=rf.check("seed",Value(1)).asInt();
+    string file=rf.check("file",Value("benchmark.json")).asString().c_str();
+
+    Bottle def_poses,def_configurations,def_derivatives;
+    def_poses.addString("full_pose");
+    def_poses.addString("xyz_pose");
+    def_configurations.addString("no_heave");
+    def_configurations.addString("heave");
+    def_configurations.addString("no_torso_no_heave");
+    def_configurations.addString("no_torso_heave");
+    def_derivatives.addString("forward_diff");
+    def_derivatives.addString("central_diff");
+
+    Bottle poses,configurations,derivatives;
+    getList(rf,"poses",def_poses,poses);
+    getList(rf,"configurations",def_configurations,configurations);
+    getList(rf,"derivatives",def_derivatives,derivatives);
+
+    ArmParameters armp(arm_type);
+    TripodKernel torso(armp.torso),lower_arm(armp.lower_arm);
+    ArmSolver fk(armp);
+
+    // the target sets are drawn once from the seed, so that
+    // every mode faces the same targets across runs; the
+    // targets are attainable as they stem from the forward
+    // kinematics of random configurations within the bounds,
+    // tripods' bending included
+    RandScalar rnd(seed);
+    deque<ArmTarget> targets[2];
+    for (int t=0; t<2; t++)
+    {
+        for (int i=0; i<N; i++)
+        {
+            Vector q=drawArmConfiguration(rnd,armp,t==1);
+            size_t L=3+armp.upper_arm.getDOF();
+
+            ArmTarget target;
+            fk.fkin(q,target.Hd);
+
+            // heaves are expressed in the tripods frames
+            TripodFrame d,din;
+            torso.fkin(q.data(),d,&din);
+            target.torso_heave=din.p[2];
+            lower_arm.fkin(q.data()+L,d,&din);
+            target.lower_arm_heave=din.p[2];
+
+            targets[t].push_back(target);
+        }
+    }
+
+    ostringstream json;
+    json.precision(6);
+    json<<"{\n";
+    json<<"  \"seed\": "<<seed<<",\n";
+    json<<"  \"targets\": "<<N<<",\n";
+    json<<"  \"arm_type\": \""<<arm_type<<"\",\n";
+    json<<"  \"arm\": [";
+
+    bool first=true;
+    for (int p=0; p<poses.size(); p++)
+    {
+        for (int c=0; c<configurations.size(); c++)
+        {
+            for (int d=0; d<derivatives.size(); d++)
+            {
+                string configuration=configurations.get(c).asString().c_str();
+                string mode=string(poses.get(p).asString().c_str())+"+"+
+                            configuration+"+"+derivatives.get(d).asString().c_str();
+
+                SolverParameters slvp;
+                if (!slvp.setMode(mode))
+                {
+                    yError("unrecognized mode \"%s\"!",mode.c_str());
+                    return 1;
+                }
+
+                yInfo("benchmarking arm in \"%s\" ...",mode.c_str());
+                bool fixed_torso=(configuration.find("no_torso")==0);
+                Report report=benchmarkArm(armp,mode,targets[fixed_torso?1:0]);
+
+                json<<(first?"\n":",\n")<<"    "
+                    <<report.toJSON(mode,"position_error_m","orientation_error_deg",true);
+                first=false;
+            }
+        }
+    }
+    json<<"\n  ],\n";
+
+    yInfo("benchmarking head \"%s\" ...",head_type.c_str());
+    Report head=benchmarkHead(head_type,rnd,N);
+    json<<"  \"head\": "<<head.toJSON(head_type,"gaze_error_deg","",false)<<",\n";
+
+    yInfo("benchmarking tripod ...");
+    Report tripod=benchmarkTripod(TripodParameters(0.09,0.0,0.2,30.0),rnd,N);
+    json<<"  \"tripod\": "<<tripod.toJSON("tripod","heave_error_m","orientation_error_deg",false)<<"\n";
+    json<<"}\n";
+
+    ofstream fout(file.c_str());
+    if (!fout.is_open())
+    {
+        yError("unable to open \"%s\"!",file.c_str());
+        return 1;
+    }
+
+    fout<<json.str();
+    fout.close();
+
+    yInfo("results saved to \"%s\"",file.c_str());
+    return 0;
+}
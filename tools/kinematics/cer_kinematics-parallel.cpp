@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2015 iCub Facility - Istituto Italiano di Tecnologia
+ * Author: Ugo Pattacini
+ * email:  ugo.pattacini@iit.it
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+*/
+
+#include <string>
+#include <cmath>
+#include <deque>
+#include <algorithm>
+
+#include <yarp/os/all.h>
+#include <yarp/sig/all.h>
+#include <yarp/math/Math.h>
+
+#include <cer_kinematics/arm.h>
+
+using namespace std;
+using namespace yarp::os;
+using namespace yarp::sig;
+using namespace yarp::math;
+using namespace cer::kinematics;
+
+
+/****************************************************************/
+class Worker : public Thread
+{
+    ArmSolver solver;
+    const deque<Matrix> &targets;
+    Semaphore &go;
+    int solves;
+    int failures;
+
+    /****************************************************************/
+    void run()
+    {
+        go.wait();
+
+        Vector q(12,0.0);
+        for (int i=0; i<solves; i++)
+        {
+            solver.setInitialGuess(q);
+            if (!solver.ikin(targets[i%targets.size()],q))
+                failures++;
+        }
+    }
+
+public:
+    /****************************************************************/
+    Worker(const ArmParameters &armp, const SolverParameters &slvp,
+           const deque<Matrix> &targets_, Semaphore &go_,
+           const int solves_) : solver(armp,slvp), targets(targets_),
+                                go(go_), solves(solves_), failures(0) { }
+
+    /****************************************************************/
+    int getFailures() const
+    {
+        return failures;
+    }
+};
+
+
+/****************************************************************/
+int main(int argc, char *argv[])
+{
+    ResourceFinder rf;
+    rf.configure(argc,argv);
+
+    // command-line options
+    string arm_type=rf.check("arm-type",Value("left")).asString().c_str();
+    string mode=rf.check("mode",Value("full_pose+no_heave")).asString().c_str();
+    int max_threads=rf.check("threads",Value(4)).asInt();
+    int solves=rf.check("solves",Value(100)).asInt();
+    int batch=std::max(rf.check("batch",Value(100)).asInt(),1);
+    double step=rf.check("step",Value(0.05)).asDouble();
+    string linear_solver=rf.check("linear-solver",Value("ma27")).asString().c_str();
+
+    // MUMPS is not reentrant and the solvers relying on it
+    // get serialized, which would defeat the scaling run
+    if (linear_solver=="mumps")
+    {
+        yError("linear solver \"%s\" serializes concurrent solves: pick a reentrant one (e.g. ma27, ma57)",
+               linear_solver.c_str());
+        return 1;
+    }
+
+    ArmParameters armp(arm_type);
+    SolverParameters slvp;
+    if (!slvp.setMode(mode))
+    {
+        yError("unrecognized mode \"%s\"",mode.c_str());
+        return 1;
+    }
+    slvp.torso_heave=0.1;
+    slvp.lower_arm_heave=0.01;
+    slvp.linear_solver=linear_solver;
+
+    // same grid as cer_kinematics-stability with top grasp
+    Vector ud(4,0.0);
+    ud[1]=1.0;
+    ud[3]=M_PI/2.0;
+
+    Matrix Hd=axis2dcm(ud);
+    Hd(2,3)=0.7-0.16;
+
+    deque<Matrix> targets;
+    for (Hd(0,3)=0.3; Hd(0,3)<=1.0; Hd(0,3)+=step)
+        for (Hd(1,3)=1.0; Hd(1,3)>=0.0; Hd(1,3)-=step)
+            targets.push_back(Hd);
+
+    yInfo("arm=%s; mode=%s; linear solver=%s; targets=%d; solves/thread=%d",
+          arm_type.c_str(),mode.c_str(),linear_solver.c_str(),
+          (int)targets.size(),solves);
+
+    double throughput1=0.0;
+    for (int n=1; n<=max_threads; n++)
+    {
+        Semaphore go(0);
+        deque<Worker*> workers;
+        for (int i=0; i<n; i++)
+        {
+            workers.push_back(new Worker(armp,slvp,targets,go,solves));
+            workers.back()->start();
+        }
+
+        double t0=Time::now();
+        for (int i=0; i<n; i++)
+            go.post();
+
+        int failures=0;
+        for (int i=0; i<n; i++)
+        {
+            workers[i]->join();
+            failures+=workers[i]->getFailures();
+            delete workers[i];
+        }
+        double dt=Time::now()-t0;
+
+        // a linear solver not available in the Ipopt build
+        // makes every single solve fail
+        if ((n==1) && (solves>0) && (failures==solves))
+        {
+            yError("all solves failed: is linear solver \"%s\" available in Ipopt?",
+                   linear_solver.c_str());
+            return 1;
+        }
+
+        double throughput=(n*solves)/dt;
+        if (n==1)
+            throughput1=throughput;
+
+        double speedup=throughput/throughput1;
+        yInfo("threads=%d; elapsed [s]=%.3f; throughput [solves/s]=%.1f; speedup=%.2f; efficiency=%.2f; failures=%d",
+              n,dt,throughput,speedup,speedup/n,failures);
+    }
+
+    // latency of the batch API over a set as large as the
+    // grasp candidates evaluated per object
+    deque<Matrix> candidates(targets.begin(),targets.begin()+
+                             std::min(batch,(int)targets.size()));
+
+    ArmSolver solver(armp,slvp);
+    for (int n=1; n<=max_threads; n++)
+    {
+        deque<Vector> q;
+        deque<int> exit_codes;
+        deque<double> timings;
+
+        double t0=Time::now();
+        bool ok=solver.ikinBatch(candidates,q,exit_codes,timings,
+                                 deque<double>(),deque<Vector>(),n);
+        double dt=Time::now()-t0;
+
+        double maxT=*std::max_element(timings.begin(),timings.end());
+        yInfo("batch: workers=%d; targets=%d; latency [ms]=%.1f; slowest solve [ms]=%.1f; all solved=%s",
+              n,(int)candidates.size(),1000.0*dt,1000.0*maxT,ok?"yes":"no");
+    }
+
+    return 0;
+}
+
@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) 2015 iCub Facility - Istituto Italiano di Tecnologia
+ * Author: Ugo Pattacini
+ * email:  ugo.pattacini@iit.it
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+*/
+
+#include <csignal>
+#include <string>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+#include <deque>
+
+#include <yarp/os/all.h>
+#include <yarp/sig/all.h>
+#include <yarp/math/Math.h>
+
+#include <cer_kinematics/arm.h>
+#include <cer_kinematics/reachability.h>
+
+using namespace std;
+using namespace yarp::os;
+using namespace yarp::sig;
+using namespace yarp::math;
+using namespace cer::kinematics;
+
+
+/****************************************************************/
+namespace
+{
+    volatile std::sig_atomic_t gSignalStatus;
+}
+
+
+/****************************************************************/
+void signal_handler(int signal)
+{
+    gSignalStatus=signal;
+}
+
+
+/****************************************************************/
+bool getBox(ResourceFinder &rf, const string &key, const Vector &def,
+            Vector &box)
+{
+    box=def;
+    if (Bottle *b=rf.find(key.c_str()).asList())
+    {
+        if (b->size()<3)
+        {
+            yError("--%s requires 3 values!",key.c_str());
+            return false;
+        }
+
+        for (int i=0; i<3; i++)
+            box[i]=b->get(i).asDouble();
+    }
+
+    return true;
+}
+
+
+/****************************************************************/
+int main(int argc, char *argv[])
+{
+    ResourceFinder rf;
+    rf.configure(argc,argv);
+
+    // command-line options
+    string arm_type=rf.check("arm-type",Value("left")).asString().c_str();
+    string grasp_type=rf.check("grasp-type",Value("top")).asString().c_str();
+    string mode=rf.check("mode",Value("full_pose")).asString().c_str();
+    double torso_heave=rf.check("torso-heave",Value(0.0)).asDouble();
+    double lower_arm_heave=rf.check("lower-arm-heave",Value(0.02)).asDouble();
+    double step=rf.check("step",Value(0.05)).asDouble();
+    double tol_pos=rf.check("tol-pos",Value(0.01)).asDouble();
+    double tol_ang=rf.check("tol-ang",Value(5.0)).asDouble();
+    double class_tol=rf.check("class-tol",Value(30.0)).asDouble();
+    string file=rf.check("file",Value("reachability-"+arm_type+"-"+grasp_type+".map")).asString().c_str();
+
+    Vector def_min(3),def_max(3),x_min,x_max;
+    def_min[0]=-0.2; def_min[1]=-1.0; def_min[2]=-0.2;
+    def_max[0]=1.0;  def_max[1]=1.0;  def_max[2]=1.2;
+    if (!getBox(rf,"x-min",def_min,x_min) || !getBox(rf,"x-max",def_max,x_max))
+        return 1;
+
+    // define solver and its parameters
+    ArmParameters armp(arm_type);
+    ArmSolver solver(armp);
+    Vector q(12,0.0);
+
+    SolverParameters slvp=solver.getSolverParameters();
+    slvp.setMode(mode);
+    slvp.torso_heave=torso_heave;
+    slvp.lower_arm_heave=lower_arm_heave;
+    solver.setSolverParameters(slvp);
+
+    // the orientation class
+    Vector ud(4,0.0);
+    if (grasp_type=="top")
+        ud[1]=1.0;
+    else
+        ud[0]=-1.0;
+    ud[3]=M_PI/2.0;
+
+    ReachabilityMap map;
+    if (!map.configure(arm_type,grasp_type,torso_heave,lower_arm_heave,
+                       slvp.full_pose,slvp.configuration,ud,class_tol,
+                       x_min,x_max,step))
+        return 1;
+
+    // the map applies to all the orientations within class_tol,
+    // hence a voxel is reachable if any orientation sampled across
+    // the class is: the reference one and those tilted by half and
+    // the whole tolerance about the three axes in both directions
+    deque<Matrix> R;
+    R.push_back(axis2dcm(ud));
+    if (slvp.full_pose)
+    {
+        for (int k=1; k<=2; k++)
+        {
+            for (int a=0; a<3; a++)
+            {
+                for (int sgn=-1; sgn<=1; sgn+=2)
+                {
+                    Vector u(4,0.0);
+                    u[a]=sgn;
+                    u[3]=(M_PI/180.0)*0.5*k*class_tol;
+                    R.push_back(R.front()*axis2dcm(u));
+                }
+            }
+        }
+    }
+
+    int N=map.getNumVoxels();
+    vector<double> manipulability(N,0.0);
+    double max_manipulability=0.0;
+    int reachable=0;
+
+    yInfo("exploring %d voxels with %d orientations each ...",N,(int)R.size());
+    double t0=Time::now();
+
+    std::signal(SIGINT,signal_handler);
+    for (int i=0; i<N; i++)
+    {
+        Vector xd=map.getVoxelCenter(i);
+
+        // neighboring voxels are explored in sequence, hence the
+        // previous solution makes a good initial guess
+        Vector q_seed=q;
+        for (size_t j=0; j<R.size(); j++)
+        {
+            Matrix Hd=R[j];
+            Hd.setSubcol(xd,0,3);
+
+            Vector q_j;
+            solver.setInitialGuess(q_seed);
+            if (!solver.ikin(Hd,q_j))
+                q_j=q_seed;
+
+            Matrix H;
+            solver.fkin(q_j,H);
+            double e_x=norm(xd-H.getCol(3).subVector(0,2));
+            double e_u=fabs(dcm2axis(Hd*H.transposed())[3]);
+
+            if ((e_x<=tol_pos) && (!slvp.full_pose || ((180.0/M_PI)*e_u<=tol_ang)))
+            {
+                // manipulability of the end-effector position
+                Matrix J;
+                solver.jacobian(q_j,J);
+                Matrix Jp=J.submatrix(0,2,0,J.cols()-1);
+                manipulability[i]=sqrt(std::max(det(Jp*Jp.transposed()),0.0));
+
+                // reachable voxels need to be marked even when singular
+                manipulability[i]=std::max(manipulability[i],1e-9);
+                max_manipulability=std::max(max_manipulability,manipulability[i]);
+                reachable++;
+
+                q=q_j;
+                break;
+            }
+        }
+
+        if ((i%100)==0)
+            yInfo("voxel %d/%d: reachable=%d",i,N,reachable);
+
+        if (gSignalStatus==SIGINT)
+        {
+            yWarning("SIGINT detected: closing ...");
+            return 1;
+        }
+    }
+
+    for (int i=0; i<N; i++)
+        map.setVoxel(i,(max_manipulability>0.0)?manipulability[i]/max_manipulability:0.0);
+    map.finalize();
+
+    yInfo("reachable voxels: %d/%d; elapsed time [s]: %g",reachable,N,Time::now()-t0);
+    if (!map.save(file))
+        return 1;
+
+    yInfo("map saved to \"%s\"",file.c_str());
+    return 0;
+}
@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2015 iCub Facility - Istituto Italiano di Tecnologia
+ * Author: Ugo Pattacini
+ * email:  ugo.pattacini@iit.it
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+*/
+
+#include <csignal>
+#include <string>
+#include <cmath>
+#include <vector>
+
+#include <yarp/os/all.h>
+#include <yarp/sig/all.h>
+#include <yarp/math/Math.h>
+
+#include <cer_kinematics/arm.h>
+#include <cer_kinematics/seeds.h>
+
+using namespace std;
+using namespace yarp::os;
+using namespace yarp::sig;
+using namespace yarp::math;
+using namespace cer::kinematics;
+
+
+/****************************************************************/
+namespace
+{
+    volatile std::sig_atomic_t gSignalStatus;
+}
+
+
+/****************************************************************/
+void signal_handler(int signal)
+{
+    gSignalStatus=signal;
+}
+
+
+/****************************************************************/
+bool getBox(ResourceFinder &rf, const string &key, const Vector &def,
+            Vector &box)
+{
+    box=def;
+    if (Bottle *b=rf.find(key.c_str()).asList())
+    {
+        if (b->size()<3)
+        {
+            yError("--%s requires 3 values!",key.c_str());
+            return false;
+        }
+
+        for (int i=0; i<3; i++)
+            box[i]=b->get(i).asDouble();
+    }
+
+    return true;
+}
+
+
+/****************************************************************/
+void getList(ResourceFinder &rf, const string &key, const Value &def,
+             Bottle &list)
+{
+    list.clear();
+    if (Bottle *b=rf.find(key.c_str()).asList())
+        list=*b;
+    else
+        list.add(rf.check(key.c_str(),def));
+}
+
+
+/****************************************************************/
+int main(int argc, char *argv[])
+{
+    ResourceFinder rf;
+    rf.configure(argc,argv);
+
+    // command-line options
+    string arm_type=rf.check("arm-type",Value("left")).asString().c_str();
+    string mode=rf.check("mode",Value("full_pose")).asString().c_str();
+    double lower_arm_heave=rf.check("lower-arm-heave",Value(0.02)).asDouble();
+    double step=rf.check("step",Value(0.05)).asDouble();
+    double tol_pos=rf.check("tol-pos",Value(0.01)).asDouble();
+    double tol_ang=rf.check("tol-ang",Value(5.0)).asDouble();
+    double w_ang=rf.check("w-ang",Value(0.1)).asDouble();
+    string file=rf.check("file",Value("seeds-"+arm_type+".lib")).asString().c_str();
+
+    Bottle grasp_types,torso_heaves;
+    getList(rf,"grasp-types",Value("top"),grasp_types);
+    getList(rf,"torso-heaves",Value(0.0),torso_heaves);
+
+    Vector def_min(3),def_max(3),x_min,x_max;
+    def_min[0]=0.2;  def_min[1]=-0.4; def_min[2]=0.4;
+    def_max[0]=0.7;  def_max[1]=0.4;  def_max[2]=1.0;
+    if (!getBox(rf,"x-min",def_min,x_min) || !getBox(rf,"x-max",def_max,x_max))
+        return 1;
+
+    if (step<=0.0)
+    {
+        yError("--step must be positive!");
+        return 1;
+    }
+
+    // define solver and its parameters
+    ArmParameters armp(arm_type);
+    ArmSolver solver(armp);
+
+    SolverParameters slvp=solver.getSolverParameters();
+    slvp.setMode(mode);
+    slvp.lower_arm_heave=lower_arm_heave;
+
+    // the library is extended rather than replaced, if present
+    SeedLibrary library(w_ang);
+    if (rf.check("append") && library.load(file))
+        yInfo("loaded %d seeds from \"%s\"",(int)library.size(),file.c_str());
+
+    int size[3];
+    for (int i=0; i<3; i++)
+        size[i]=(int)floor((x_max[i]-x_min[i])/step)+1;
+    int N=size[0]*size[1]*size[2];
+
+    yInfo("sweeping %d targets x %d grasps x %d heaves ...",
+          N,grasp_types.size(),torso_heaves.size());
+    double t0=Time::now();
+    int solved=0,total=0;
+
+    std::signal(SIGINT,signal_handler);
+    for (int g=0; g<grasp_types.size(); g++)
+    {
+        string grasp_type=grasp_types.get(g).asString().c_str();
+        Vector ud(4,0.0);
+        if (grasp_type=="top")
+            ud[1]=1.0;
+        else
+            ud[0]=-1.0;
+        ud[3]=M_PI/2.0;
+        Matrix Hd=axis2dcm(ud);
+
+        for (int h=0; h<torso_heaves.size(); h++)
+        {
+            slvp.torso_heave=torso_heaves.get(h).asDouble();
+            solver.setSolverParameters(slvp);
+            Vector q(12,0.0);
+
+            // the sweep follows a serpentine path so that
+            // consecutive targets are neighbors, hence the
+            // previous solution makes a good initial guess
+            for (int i=0; i<N; i++)
+            {
+                int iz=i/(size[0]*size[1]);
+                int iy=(i/size[0])%size[1];
+                int ix=i%size[0];
+                if ((iz&1)!=0)
+                    iy=size[1]-1-iy;
+                if (((iz*size[1]+iy)&1)!=0)
+                    ix=size[0]-1-ix;
+
+                Vector xd(3);
+                xd[0]=x_min[0]+ix*step;
+                xd[1]=x_min[1]+iy*step;
+                xd[2]=x_min[2]+iz*step;
+                Hd.setSubcol(xd,0,3);
+
+                solver.setInitialGuess(q);
+                if (!solver.ikin(Hd,q))
+                    q=solver.getInitialGuess();
+
+                Matrix H;
+                solver.fkin(q,H);
+                double e_x=norm(xd-H.getCol(3).subVector(0,2));
+                double e_u=fabs(dcm2axis(Hd*H.transposed())[3]);
+
+                // only accurate solutions are worth storing
+                if ((e_x<=tol_pos) && (!slvp.full_pose || ((180.0/M_PI)*e_u<=tol_ang)))
+                {
+                    library.add(Hd,slvp.torso_heave,q);
+                    solved++;
+                }
+                total++;
+
+                if ((total%100)==0)
+                    yInfo("target %d: solved=%d",total,solved);
+
+                if (gSignalStatus==SIGINT)
+                {
+                    yWarning("SIGINT detected: closing ...");
+                    return 1;
+                }
+            }
+        }
+    }
+
+    yInfo("solved targets: %d/%d; elapsed time [s]: %g",solved,total,Time::now()-t0);
+    if (!library.save(file))
+        return 1;
+
+    yInfo("%d seeds saved to \"%s\"",(int)library.size(),file.c_str());
+    return 0;
+}
@@ -52,6 +52,30 @@ void signal_handler(int signal)
 }
 
 
+/****************************************************************/
+class IterationsCounter : public SolverIterateCallback
+{
+    int iterations;
+
+public:
+    /****************************************************************/
+    IterationsCounter() : iterations(0) { }
+
+    /****************************************************************/
+    bool exec(const int iter, const Matrix &Hd, const Vector &q, const Matrix &Hee)
+    {
+        iterations=iter;
+        return true;
+    }
+
+    /****************************************************************/
+    int get() const
+    {
+        return iterations;
+    }
+};
+
+
 /****************************************************************/
 int main(int argc, char *argv[])
 {
@@ -65,6 +89,12 @@ int main(int argc, char *argv[])
     double external_weight=rf.check("external-weight",Value(2.0)).asDouble();
     double floor_z=rf.check("floor-z",Value(-0.16)).asDouble();
     double step=rf.check("step",Value(0.05)).asDouble();
+    // the exact Hessian is compared against the L-BFGS approximation
+    // by running the same grid with and without --hessian and
+    // looking at the summary printed at the end; no reference
+    // figures are recorded here, as they depend on the machine
+    // and on the linear solver Ipopt is built with
+    bool hessian=rf.check("hessian");
 
     // define solver and its parameters
     ArmParameters armp(arm_type);
@@ -79,8 +109,12 @@ int main(int argc, char *argv[])
     slvp.torso_heave=0.1;
     slvp.lower_arm_heave=0.01;
     slvp.weight_postural_torso=0.001;
+    slvp.use_hessian=hessian;
     solver.setSolverParameters(slvp);
 
+    IterationsCounter counter;
+    solver.enableIterateCallback(counter);
+
     // init CoMs, weights and support polygon
     ArmCOM armCOM(solver,external_weight,floor_z);
 
@@ -103,6 +137,10 @@ int main(int argc, char *argv[])
     double stdT=0.0;
     double N=0.0;
 
+    // iterations statistics
+    int maxIter=0;
+    double avgIter=0.0;
+
     ofstream fout;
     fout.open("data.log");
 
@@ -127,6 +165,9 @@ int main(int argc, char *argv[])
             double avgT_n1=(avgT*N+dt)/(N+1.0);
             stdT=sqrt((N*(stdT*stdT+avgT*avgT)+dt*dt)/(N+1.0)-avgT_n1*avgT_n1);
             avgT=avgT_n1;
+
+            maxIter=std::max(maxIter,counter.get());
+            avgIter=(avgIter*N+counter.get())/(N+1.0);
             N+=1.0;
 
             deque<Vector> coms;
@@ -158,6 +199,7 @@ int main(int argc, char *argv[])
             yInfo("%s",stream.str().c_str());
             yInfo("solving time [ms]: min=%d, avg=%d, std=%d, max=%d;",
                   (int)minT,(int)avgT,(int)stdT,(int)maxT);
+            yInfo("iterations [#]: avg=%.1f, max=%d;",avgIter,maxIter);
 
             if (gSignalStatus==SIGINT)
             {
@@ -171,6 +213,9 @@ int main(int argc, char *argv[])
     }
 
     fout.close();
+
+    yInfo("summary (%s Hessian, %d targets): solving time [ms]: avg=%.1f, std=%.1f, max=%.1f; iterations [#]: avg=%.1f, max=%d;",
+          hessian?"exact":"L-BFGS",(int)N,avgT,stdT,maxT,avgIter,maxIter);
     return 0;
 }
 
@@ -110,6 +110,7 @@ class IKSolver : public RFModule
     Target target;
     ArmSolver solver;
     double solverTs;
+    bool differential;
     Vector q;
 
 public:
@@ -125,6 +126,8 @@ public:
         double targetTs=rf.check("targetTs",Value(0.05)).asDouble();
         double f=rf.check("f",Value(0.1)).asDouble();
         double R=rf.check("R",Value(0.1)).asDouble();
+        bool tracking=rf.check("tracking");
+        differential=rf.check("differential");
         
         Property options;
         options.put("Ts",targetTs);
@@ -139,6 +142,7 @@ public:
         p.torso_heave=0.1;
         p.lower_arm_heave=0.05;
         p.warm_start=true;
+        p.tracking=tracking;
 
         solver.setArmParameters(ArmParameters(arm_type));
         solver.setSolverParameters(p);
@@ -171,8 +175,17 @@ public:
         Hd(1,3)=xd[1];
         Hd(2,3)=xd[2];
 
-        solver.setInitialGuess(q);
-        solver.ikin(Hd,q);
+        if (differential)
+        {
+            Vector q_next;
+            solver.ikinDiff(Hd,q,q_next);
+            q=q_next;
+        }
+        else
+        {
+            solver.setInitialGuess(q);
+            solver.ikin(Hd,q);
+        }
 
         Matrix H;
         solver.fkin(q,H);
@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2015 iCub Facility - Istituto Italiano di Tecnologia
+ * Author: Ugo Pattacini
+ * email:  ugo.pattacini@iit.it
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+*/
+
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include <yarp/os/all.h>
+#include <yarp/sig/all.h>
+#include <yarp/math/Math.h>
+
+#include <iCub/ctrl/math.h>
+
+#include <cer_kinematics/tripod.h>
+
+using namespace std;
+using namespace yarp::os;
+using namespace yarp::sig;
+using namespace yarp::math;
+using namespace iCub::ctrl;
+using namespace cer::kinematics;
+
+
+/****************************************************************/
+struct Statistics
+{
+    double min,max,avg;
+    double N;
+
+    /****************************************************************/
+    Statistics() : min(std::numeric_limits<double>::max()),
+                   max(0.0), avg(0.0), N(0.0) { }
+
+    /****************************************************************/
+    void update(const double val)
+    {
+        min=std::min(min,val);
+        max=std::max(max,val);
+        avg=(avg*N+val)/(N+1.0);
+        N+=1.0;
+    }
+
+    /****************************************************************/
+    string toString(const double scale=1.0) const
+    {
+        ostringstream stream;
+        stream<<"min="<<scale*min<<", avg="<<scale*avg<<", max="<<scale*max;
+        return stream.str();
+    }
+};
+
+
+/****************************************************************/
+class Evaluator
+{
+    TripodSolver &solver;
+
+public:
+    Statistics dt,e_z,e_u;
+    int failures;
+
+    /****************************************************************/
+    Evaluator(TripodSolver &solver_) : solver(solver_), failures(0) { }
+
+    /****************************************************************/
+    void solve(const Vector &hpr, Vector &lll)
+    {
+        double t0=Time::now();
+        if (!solver.ikin(hpr,lll))
+            failures++;
+        dt.update(Time::now()-t0);
+
+        Vector ypr(3,0.0);
+        ypr[1]=CTRL_DEG2RAD*hpr[1];
+        ypr[2]=CTRL_DEG2RAD*hpr[2];
+        Matrix Hd=ypr2dcm(ypr);
+
+        Matrix H;
+        solver.fkin(lll,H);
+        Vector e=dcm2axis(Hd*H.transposed());
+
+        e_z.update(fabs(hpr[0]-H(2,3)));
+        e_u.update(fabs(e[3]));
+    }
+};
+
+
+/****************************************************************/
+int main(int argc, char *argv[])
+{
+    ResourceFinder rf;
+    rf.configure(argc,argv);
+
+    // command-line options
+    double r=rf.check("r",Value(0.09)).asDouble();
+    double l_min=rf.check("l-min",Value(0.0)).asDouble();
+    double l_max=rf.check("l-max",Value(0.2)).asDouble();
+    double alpha_max=rf.check("alpha-max",Value(30.0)).asDouble();
+    double step_heave=rf.check("step-heave",Value(0.01)).asDouble();
+    double step_angle=rf.check("step-angle",Value(2.0)).asDouble();
+
+    TripodParameters params(r,l_min,l_max,alpha_max);
+    TripodSolver newton(params),ipopt(params);
+    ipopt.useIpopt(true);
+
+    Evaluator evNewton(newton),evIpopt(ipopt);
+    Statistics e_lll;
+
+    ofstream fout;
+    fout.open("data.log");
+
+    // sweep the whole (heave,pitch,roll) workspace, also beyond
+    // the permitted bending to stress the projection
+    double angle_max=alpha_max+10.0;
+    Vector hpr(3),lllNewton(3,l_min),lllIpopt(3,l_min);
+    for (hpr[0]=l_min; hpr[0]<=l_max; hpr[0]+=step_heave)
+    {
+        for (hpr[1]=-angle_max; hpr[1]<=angle_max; hpr[1]+=step_angle)
+        {
+            for (hpr[2]=-angle_max; hpr[2]<=angle_max; hpr[2]+=step_angle)
+            {
+                evNewton.solve(hpr,lllNewton);
+
+                // Ipopt is warm started from its previous solution,
+                // as it happens within the motion control
+                ipopt.setInitialGuess(lllIpopt);
+                evIpopt.solve(hpr,lllIpopt);
+
+                e_lll.update(norm(lllNewton-lllIpopt));
+
+                ostringstream stream;
+                stream.precision(5);
+                stream<<fixed;
+
+                stream<<hpr.toString(5,5).c_str();
+                stream<<"\t";
+                stream<<lllNewton.toString(5,5).c_str();
+                stream<<"\t";
+                stream<<lllIpopt.toString(5,5).c_str();
+
+                fout<<stream.str()<<endl;
+            }
+        }
+    }
+
+    fout.close();
+
+    yInfo("samples [#]: %d",(int)evNewton.dt.N);
+    yInfo("newton: solving time [us]: %s;",evNewton.dt.toString(1e6).c_str());
+    yInfo("newton: heave error [mm]: %s;",evNewton.e_z.toString(1e3).c_str());
+    yInfo("newton: orientation error [deg]: %s;",evNewton.e_u.toString(CTRL_RAD2DEG).c_str());
+    yInfo("newton: failures [#]: %d;",evNewton.failures);
+    yInfo("ipopt: solving time [us]: %s;",evIpopt.dt.toString(1e6).c_str());
+    yInfo("ipopt: heave error [mm]: %s;",evIpopt.e_z.toString(1e3).c_str());
+    yInfo("ipopt: orientation error [deg]: %s;",evIpopt.e_u.toString(CTRL_RAD2DEG).c_str());
+    yInfo("ipopt: failures [#]: %d;",evIpopt.failures);
+    yInfo("newton vs ipopt: elongations distance [mm]: %s;",e_lll.toString(1e3).c_str());
+
+    return 0;
+}